@@ -11,11 +11,15 @@
 #include "includes/global.h"
 #include "includes/const.h"
 #include "includes/m_utils.h"
+#include "includes/m_fixed.h"
+#include "includes/arena.h"
+#include "includes/EarthRot.h"
 
 #include "includes/position.h"
 #include "includes/Mjday.h"
 #include "includes/ode.h"
 #include "includes/Accel.h"
+#include "includes/AccelHarmonic.h"
 #include "includes/LTC.h"
 #include "includes/gmst.h"
 #include "includes/R_z.h"
@@ -36,7 +40,7 @@
 int main()
 {
 	DE430Coeff(2285,1020);
-	GGM03S(181);
+	GGM03S(21);    // Degrees 0..20 of AuxParam.n
 	eop19620101(21413);
 	GEOS3(46);
 	
@@ -56,6 +60,12 @@ int main()
 	extern int n_eqn;
 	n_eqn = 6;
 
+	double Mjd0 = Mjday(1995,1,29,2,38,0);
+
+	// Earth rotation over the whole arc, the initial propagation to Mjd0 included
+	EarthRot *erot = EarthRot_create(fmin(Mjd0,obs[0][0]),obs[fobs-1][0],1e-10);
+	EarthRot_bind(erot);
+
 	double *r2, *v2;
 	anglesg(obs[0][1],obs[8][1],obs[17][1],obs[0][2],obs[8][2],obs[17][2],
 			obs[0][0],obs[8][0],obs[17][0],Rs,Rs,Rs,&r2,&v2);
@@ -64,7 +74,6 @@ int main()
 	Y[0] = r2[0]; Y[1] = r2[1]; Y[2] = r2[2];
 	Y[3] = v2[0]; Y[4] = v2[1]; Y[5] = v2[2];
 
-	double Mjd0 = Mjday(1995,1,29,2,38,0);
 	double Mjd_UTC = obs[8][0];
 
 	extern Param AuxParam;
@@ -74,6 +83,12 @@ int main()
 	AuxParam.sun     = 1;
 	AuxParam.moon    = 1;
 	AuxParam.planets = 1;
+	AuxParam.tol     = 0.0;   // Fixed degree; > 0 adapts it to the radius
+
+	// Everything allocated from here on, the temporaries of the ode
+	// right-hand sides included, comes from one arena sized at startup
+	Arena *ws = arena_create(256 * 1024);
+	arena_bind(ws);
 
 	int iflag = 1;
 	int iwork[5];
@@ -90,23 +105,49 @@ int main()
 		P[i][i]=1e3;
 	}
 
-	double **LT = LTC(lon,lat);
+	Mat3 LT = LTC(lon,lat);
 
 	double *yPhi = v_create(42);
 	double **Phi = m_zeros(6,6);
-
-	// Measurement loop
+	double **Qdt = m_zeros(6,6);
+	double **Phi0 = m_eye(6);
+
+	// Measurement loop. The state, driven by the full force model, and
+	// the state transition matrix from the epoch, Phi(t,0), driven by
+	// the gravity gradient, are integrated together by one context over
+	// the whole pass, in time since the epoch; every measurement update
+	// is a warm restart. The transition matrix of an interval is
+	// Phi(t,0)*Phi(t_old,0)^-1, where the inverse is that of a
+	// symplectic matrix, as the variational equations are those of a
+	// gravity field.
 	t = 0.0;
+	AuxParam.Mjd_UTC = Mjd0;
+
+	OdeContext *ode_Phi = ode_create(VarEqn_full, 42, relerr, abserr);
+	ode_start(ode_Phi, 0.0);
+	for(int ii=0; ii<6; ii++) {
+		yPhi[ii] = Y[ii];
+		for(int jj=0; jj<6; jj++) {
+			yPhi[6*(jj+1)+ii] = (ii == jj) ? 1.0 : 0.0;
+		}
+	}
 	
+#ifdef ODE_STATS
 	double t_old;
+#endif
+	Mat6 Phi_t, Phi_inv;
 	double x_pole, y_pole, UT1_UTC, LOD, dpsi, deps, dx_pole, dy_pole, TAI_UTC;
 	double UT1_TAI, UTC_GPS, UT1_GPS, TT_UTC, GPS_UTC;
-	double Mjd_TT, Mjd_UT1, t_aux;
-	double theta, **U, *r = v_create(3), *s;
-	double Azim, Elev, *dAds, *dEds, *aux, *K, *dAdY, *dEdY, Dist, *dDds, *dDdY;
+	double Mjd_TT, Mjd_UT1;
+	double theta;
+	Mat3 U, LU;
+	Vec3 s, aux;
+	double Azim, Elev, dAds[3], dEds[3], K[6], dAdY[6], dEdY[6], Dist, dDdY[6];
 	for(int i=0; i<fobs; i++) {
+#ifdef ODE_STATS
 		// Previous step
 		t_old = t;
+#endif
 
 		// Time increment and propagation
 		Mjd_UTC = obs[i][0];                       // Modified Julian Date
@@ -117,96 +158,92 @@ int main()
 		
 		Mjd_TT = Mjd_UTC + TT_UTC/86400.0;
 		Mjd_UT1 = Mjd_TT + (UT1_UTC-TT_UTC)/86400.0;
-		AuxParam.Mjd_UTC = Mjd_UTC;
-		AuxParam.Mjd_TT = Mjd_TT;
 		
+		ode_advance(ode_Phi, yPhi, t);
 		for(int ii=0; ii<6; ii++) {
-			yPhi[ii] = Y[ii];
-			for(int jj=0; jj<6; jj++) { 
-				if(ii==jj) {
-					yPhi[6*(jj+1)+ii] = 1.0;
-				}
-				else {
-					yPhi[6*(jj+1)+ii] = 0.0;
-				}
-			}
+			Y[ii] = yPhi[ii];
 		}
-
-		n_eqn = 42;
-		t_aux = 0.0;
-		iflag = 1;
-		work = v_create(100 + 21 * n_eqn);
-		ode(VarEqn, n_eqn, yPhi, &t_aux, t-t_old, relerr, abserr, &iflag, work, iwork);
-
-		// Extract state transition matrices
+#ifdef ODE_STATS
+		// Propagation cost of the interval, the previous warm restart included
+		printf("Measurement %2d, %.1f s\n", i+1, t-t_old);
+		ode_stats_print(&ode_Phi->stats);
+		ode_stats_reset(ode_Phi);
+#endif
+
+		// State transition matrix of the interval: Phi(t,0) times the
+		// inverse of Phi(t_old,0), [Phi_vv' -Phi_rv'; -Phi_vr' Phi_rr']
 		for(int j=0; j<6; j++) {
-			for (int ii = 0; ii < 6; ii++){
-				Phi[ii][j] = yPhi[6*(j+1)+ii];
+			for(int ii=0; ii<6; ii++) {
+				Phi_t.m[ii][j] = yPhi[6*(j+1)+ii];
+			}
+		}
+		for(int ii=0; ii<3; ii++) {
+			for(int j=0; j<3; j++) {
+				Phi_inv.m[ii][j]     =  Phi0[j+3][ii+3];
+				Phi_inv.m[ii][j+3]   = -Phi0[j][ii+3];
+				Phi_inv.m[ii+3][j]   = -Phi0[j+3][ii];
+				Phi_inv.m[ii+3][j+3] =  Phi0[j][ii];
+			}
+		}
+		Mat6 Phi_i = m6_dot(Phi_t, Phi_inv);
+		for(int ii=0; ii<6; ii++) {
+			for(int j=0; j<6; j++) {
+				Phi[ii][j] = Phi_i.m[ii][j];
+				Phi0[ii][j] = Phi_t.m[ii][j];
 			}
 		}
-
-		n_eqn = 6;
-		t_aux = 0;
-		iflag = 1;
-		work = v_create(100 + 21 * n_eqn);
-		ode(Accel, n_eqn, Y, &t_aux, t-t_old, relerr, abserr, &iflag, work, iwork);
 
 
 		// Topocentric coordinates
 		theta = gmst(Mjd_UT1);                    // Earth rotation
 		U = R_z(theta);
-		for(int j=0; j<3; j++) {
-			r[j] = Y[j];
-		}
-		s = m_dot_v(LT,3,3,v_sum(m_dot_v(U,3,3,r,3),3,v_mul_scalar(Rs,3,-1.0),3),3); // Topocentric position [m]
+		LU = m3_dot(LT,U);
+		s = m3_dot_v3(LT,v3_sub(m3_dot_v3(U,v3_load(Y)),v3_load(Rs))); // Topocentric position [m]
 
 		// Time update
-		P = TimeUpdate(P, Phi, m_zeros(6,6));
+		TimeUpdate(P, Phi, Qdt);
 
 		// Azimuth and partials
-		AzElPa(s, &Azim, &Elev, &dAds, &dEds);     // Azimuth, Elevation
-		aux = v_dot_m(dAds,3,m_dot(LT,3,3,U,3,3),3,3);
-		dAdY = v_create(6);
+		AzElPa(s.v, &Azim, &Elev, dAds, dEds);     // Azimuth, Elevation
+		aux = v3_dot_m3(v3_load(dAds),LU);
 		for(int j=0; j<3; j++) {
-			dAdY[j] = aux[j];
+			dAdY[j] = aux.v[j];
 			dAdY[j+3] = 0.0;
 		}
 
 		// Measurement update
-		MeasUpdate(obs[i][1],Azim,sigma_az,dAdY,&K,&Y,&P);
+		MeasUpdate(obs[i][1],Azim,sigma_az,dAdY,K,Y,P);
 
 		// Elevation and partials
+		s = m3_dot_v3(LT,v3_sub(m3_dot_v3(U,v3_load(Y)),v3_load(Rs))); // Topocentric position [m]
+		AzElPa(s.v, &Azim, &Elev, dAds, dEds);     // Azimuth, Elevation
+		aux = v3_dot_m3(v3_load(dEds),LU);
 		for(int j=0; j<3; j++) {
-			r[j] = Y[j];
-		}
-		s = m_dot_v(LT,3,3,v_sum(m_dot_v(U,3,3,r,3),3,v_mul_scalar(Rs,3,-1.0),3),3); // Topocentric position [m]
-		AzElPa(s, &Azim, &Elev, &dAds, &dEds);     // Azimuth, Elevation
-		aux = v_dot_m(dEds,3,m_dot(LT,3,3,U,3,3),3,3);
-		dEdY = v_create(6);
-		for(int j=0; j<3; j++) {
-			dEdY[j] = aux[j];
+			dEdY[j] = aux.v[j];
 			dEdY[j+3] = 0.0;
 		}
 
 		// Measurement update
-		MeasUpdate(obs[i][2],Elev,sigma_el,dEdY,&K,&Y,&P);
+		MeasUpdate(obs[i][2],Elev,sigma_el,dEdY,K,Y,P);
 
 		// Range and partials
+		s = m3_dot_v3(LT,v3_sub(m3_dot_v3(U,v3_load(Y)),v3_load(Rs))); // Topocentric position [m]
+		Dist = v3_norm(s);
+		aux = v3_dot_m3(v3_mul_scalar(s,1/Dist),LU); // Range
 		for(int j=0; j<3; j++) {
-			r[j] = Y[j];
-		}
-		s = m_dot_v(LT,3,3,v_sum(m_dot_v(U,3,3,r,3),3,v_mul_scalar(Rs,3,-1.0),3),3); // Topocentric position [m]
-		Dist = v_norm(s,3);
-		dDds = v_mul_scalar(s,3,1/Dist);         // Range
-		aux = v_dot_m(dDds,3,m_dot(LT,3,3,U,3,3),3,3);
-		dDdY = v_create(6);
-		for(int j=0; j<3; j++) {
-			dDdY[j] = aux[j];
+			dDdY[j] = aux.v[j];
 			dDdY[j+3] = 0.0;
 		}
 		// Measurement update
-		MeasUpdate(obs[i][3],Dist,sigma_range,dDdY,&K,&Y,&P);
+		MeasUpdate(obs[i][3],Dist,sigma_range,dDdY,K,Y,P);
+
+		// Warm restart from the updated state
+		for(int ii=0; ii<6; ii++) {
+			yPhi[ii] = Y[ii];
+		}
+		ode_correct(ode_Phi, yPhi);
 	}
+	ode_free(ode_Phi);
 
 	IERS(obs[45][0],'l',&x_pole,&y_pole,&UT1_UTC,&LOD,&dpsi,&deps,&dx_pole,&dy_pole,&TAI_UTC);
 	timediff(UT1_UTC,TAI_UTC,&UT1_TAI,&UTC_GPS,&UT1_GPS,&TT_UTC,&GPS_UTC);
@@ -214,10 +251,10 @@ int main()
 	AuxParam.Mjd_UTC = Mjd_UTC;
 	AuxParam.Mjd_TT = Mjd_TT;
 
-	t_aux = 0.0;
+	// Back to the epoch, with a fresh start of the integrator
+	t = 0.0;
 	iflag = 1;
-	work = v_create(100 + 21 * n_eqn);
-	ode(Accel, n_eqn, Y, &t_aux, -(obs[45][0]-obs[0][0])*86400.0, relerr, abserr, &iflag, work, iwork);
+	ode(Accel, n_eqn, Y, &t, -(obs[45][0]-obs[0][0])*86400.0, relerr, abserr, &iflag, work, iwork);
 
 	double *Y_true = v_create(n_eqn);
 	Y_true[0] = 5753.173e3; Y_true[1] = 2673.361e3; Y_true[2] = 3440.304e3;
@@ -231,6 +268,9 @@ int main()
 	printf("dVx	%10.1lf [m/s]\n",Y[3]-Y_true[3]);
 	printf("dVy	%10.1lf [m/s]\n",Y[4]-Y_true[4]);
 	printf("dVz	%10.1lf [m/s]\n",Y[5]-Y_true[5]);
+
+	printf("\nArena peak	%10zu [bytes]\n",arena_peak(ws));
+	AccelHarmonic_report();
 	
     return 0;
 }
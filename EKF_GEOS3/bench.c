@@ -0,0 +1,615 @@
+/** @file bench.c
+ *  @brief Benchmark driver.
+ *
+ *  This driver contains the code for the benchmarks. Every
+ *  benchmark prints the time per evaluation of the variants
+ *  it compares.
+ *
+ *  @author Miguel Alonso Angulo.
+ *  @bug No know bugs.
+ */
+
+#include "includes/global.h"
+#include "includes/const.h"
+#include "includes/m_utils.h"
+#include "includes/m_fixed.h"
+#include "includes/EarthRot.h"
+#include "includes/PoleMatrix.h"
+#include "includes/IERS.h"
+#include "includes/Accel.h"
+#include "includes/AccelHarmonic.h"
+#include "includes/Cunningham.h"
+#include "includes/GravGrid.h"
+#include "includes/GravModel.h"
+#include "includes/Cheb3D.h"
+#include "includes/JPL_Eph_DE430.h"
+#include "includes/EccAnom.h"
+#include "includes/ode.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <math.h>
+
+/** @brief Wall-clock time.
+ *
+ *  @return Seconds since an arbitrary origin.
+ */
+double seconds() {
+	struct timespec ts;
+	
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	
+	return ts.tv_sec + 1e-9*ts.tv_nsec;
+}
+
+/** @brief Console printing of one benchmark result.
+ *
+ *  @param [in] name Name of the variant.
+ *  @param [in] t Elapsed time [s].
+ *  @param [in] n Number of evaluations.
+ */
+void bench_show(const char *name, double t, int n) {
+	printf("%-36s %12.1f ns/eval\n", name, 1e9*t/n);
+}
+
+/** @brief Benchmark of the Earth rotation provider: ICRF to ITRF
+ *  matrix and Accel, exact and interpolated.
+ *
+ *  @return 0.
+ */
+int EarthRot_bench() {
+	extern Param AuxParam;
+	int n = 20000;
+	double Mjd_UTC = 49746.1101504629, span = 0.25, t, sum = 0.0;
+	Mat3 E;
+	
+	EarthRot *er = EarthRot_create(Mjd_UTC, Mjd_UTC + span, 1e-10);
+	printf("\nEarthRot: %d nodes, h = %g d, max error %.2e rad\n", er->n, er->h, er->err);
+	
+	for(int k = 0; k < 2; k++) {
+		EarthRot *p = (k == 0) ? NULL : er;
+		
+		t = seconds();
+		for(int i = 0; i < n; i++) {
+			double Mjd = Mjd_UTC + span*i/n;
+			EOP eop;
+			
+			IERS_eop(Mjd,'l',&eop);
+			E = m3_dot(m3_dot(PoleMatrix(eop.x_pole,eop.y_pole),
+							  EarthRot_GHA(p,Mjd + eop.UT1_UTC/86400.0)),
+					   EarthRot_NP(p,Mjd + (32.184 + eop.TAI_UTC)/86400.0));
+			sum += E.m[0][0];
+		}
+		bench_show((k == 0) ? "E(t) exact" : "E(t) EarthRot", seconds()-t, n);
+	}
+	
+	AuxParam.Mjd_UTC = Mjd_UTC;
+	AuxParam.n = 20;
+	AuxParam.m = 20;
+	AuxParam.sun = 1;
+	AuxParam.moon = 1;
+	AuxParam.planets = 1;
+	
+	double Y[6] = {6221397.62857869, 2867713.77965741, 3006155.9850995,
+				   4645.0472516175, -2752.21591588182, -7507.99940986939};
+	double *dY;
+	n = n/10;
+	for(int k = 0; k < 2; k++) {
+		EarthRot_bind((k == 0) ? NULL : er);
+		
+		t = seconds();
+		for(int i = 0; i < n; i++) {
+			Accel(span*86400.0*i/n, Y, &dY);
+			sum += dY[3];
+			v_free(dY,6);
+		}
+		bench_show((k == 0) ? "Accel exact" : "Accel EarthRot", seconds()-t, n);
+	}
+	EarthRot_bind(NULL);
+	EarthRot_free(er);
+	
+	return sum == 0.0;
+}
+
+/** @brief Benchmark of the harmonic gravity field at several
+ *  degrees: acceleration, and acceleration with gradient by
+ *  central differences and by the Cunningham recursions.
+ *
+ *  @return 0.
+ */
+int AccelHarmonic_bench() {
+	int n = 20000, deg[6] = {2, 4, 8, 20, 36, 70};
+	double t, sum = 0.0;
+	Vec3 r = {{6221397.62857869, 2867713.77965741, 3006155.9850995}}, a, dr;
+	Mat3 E = m3_eye(), G;
+	char name[40];
+	
+	printf("\nAccelHarmonic\n");
+	
+	for(int k = 0; k < 6; k++) {
+		t = seconds();
+		for(int i = 0; i < n; i++) {
+			r.v[2] = 3006155.9850995 + i;
+			a = AccelHarmonic(r, E, deg[k], deg[k]);
+			sum += a.v[0];
+		}
+		sprintf(name, "AccelHarmonic %dx%d", deg[k], deg[k]);
+		bench_show(name, seconds()-t, n);
+		
+		t = seconds();
+		for(int i = 0; i < n/4; i++) {
+			r.v[2] = 3006155.9850995 + i;
+			a = AccelHarmonic(r, E, deg[k], deg[k]);
+			for(int j = 0; j < 3; j++) {
+				dr = r;
+				dr.v[j] += 0.5;
+				G.m[0][j] = AccelHarmonic(dr, E, deg[k], deg[k]).v[0];
+				dr.v[j] -= 1.0;
+				G.m[0][j] -= AccelHarmonic(dr, E, deg[k], deg[k]).v[0];
+			}
+			sum += a.v[0] + G.m[0][0];
+		}
+		sprintf(name, "  + differences gradient");
+		bench_show(name, seconds()-t, n/4);
+		
+		t = seconds();
+		for(int i = 0; i < n; i++) {
+			r.v[2] = 3006155.9850995 + i;
+			a = Cunningham(r, E, deg[k], deg[k], NULL);
+			sum += a.v[0];
+		}
+		sprintf(name, "Cunningham %dx%d", deg[k], deg[k]);
+		bench_show(name, seconds()-t, n);
+		
+		t = seconds();
+		for(int i = 0; i < n; i++) {
+			r.v[2] = 3006155.9850995 + i;
+			a = Cunningham(r, E, deg[k], deg[k], &G);
+			sum += a.v[0] + G.m[0][0];
+		}
+		sprintf(name, "  + analytic gradient");
+		bench_show(name, seconds()-t, n);
+	}
+	
+	return sum == 0.0;
+}
+
+/** @brief Benchmark of a catalog of satellites, one AccelHarmonic
+ *  call per object against AccelHarmonic_batch.
+ *
+ *  @return 0.
+ */
+int AccelHarmonic_batch_bench() {
+	int N = 1000, n = 20, deg[2] = {20, 70};
+	double t, sum = 0.0;
+	double *x = v_create(N), *y = v_create(N), *z = v_create(N);
+	double *ax = v_create(N), *ay = v_create(N), *az = v_create(N);
+	char name[40];
+	
+	for(int i = 0; i < N; i++) {
+		double d = 6778e3 + 3e4*(i%100), lat = 1.3*sin(0.7*i), lon = 0.9*i;
+		
+		x[i] = d*cos(lat)*cos(lon);
+		y[i] = d*cos(lat)*sin(lon);
+		z[i] = d*sin(lat);
+	}
+	
+	printf("\nAccelHarmonic_batch: %d satellites\n", N);
+	
+	for(int k = 0; k < 2; k++) {
+		t = seconds();
+		for(int j = 0; j < n; j++) {
+			for(int i = 0; i < N; i++) {
+				Vec3 r = {{x[i], y[i], z[i]}};
+				sum += AccelHarmonic(r, m3_eye(), deg[k], deg[k]).v[0];
+			}
+		}
+		sprintf(name, "AccelHarmonic %dx%d", deg[k], deg[k]);
+		bench_show(name, seconds()-t, n*N);
+		
+		t = seconds();
+		for(int j = 0; j < n; j++) {
+			AccelHarmonic_batch(N, x, y, z, deg[k], deg[k], ax, ay, az);
+			sum += ax[0];
+		}
+		sprintf(name, "AccelHarmonic_batch %dx%d", deg[k], deg[k]);
+		bench_show(name, seconds()-t, n*N);
+	}
+	
+	v_free(x, N); v_free(y, N); v_free(z, N);
+	v_free(ax, N); v_free(ay, N); v_free(az, N);
+	
+	return sum == 0.0;
+}
+
+/** @brief Benchmark of the altitude-adaptive degree over one
+ *  revolution of a geostationary transfer orbit, sampled uniformly
+ *  in time: fixed 20x20 against the degree of AccelHarmonic_degree.
+ *
+ *  @return 0.
+ */
+int AccelHarmonic_degree_bench() {
+	int n = 20000, n_max = 20, full = 0;
+	double rp = 6678e3, ra = 42164e3, tol = 1e-9;
+	double a = (rp+ra)/2, e = (ra-rp)/(ra+rp), t, sum = 0.0, mean = 0.0;
+	Vec3 *r = (Vec3 *) malloc(n*sizeof(Vec3));
+	
+	for(int i = 0; i < n; i++) {
+		double E = EccAnom(2.0*M_PI*i/n, e);
+		double x = a*(cos(E)-e), y = a*sqrt(1.0-e*e)*sin(E);
+		
+		r[i] = (Vec3) {{x, 0.5*y, 0.866*y}};
+	}
+	
+	printf("\nAccelHarmonic_degree: GTO %.0f x %.0f km, tol %g m/s^2\n", rp/1e3, ra/1e3, tol);
+	
+	t = seconds();
+	for(int i = 0; i < n; i++) {
+		sum += AccelHarmonic(r[i], m3_eye(), n_max, n_max).v[0];
+	}
+	bench_show("AccelHarmonic 20x20", seconds()-t, n);
+	
+	t = seconds();
+	for(int i = 0; i < n; i++) {
+		int d = AccelHarmonic_degree(v3_norm(r[i]), n_max, tol);
+		
+		sum += AccelHarmonic(r[i], m3_eye(), d, d).v[0];
+		mean += d;
+		full += (d == n_max);
+	}
+	bench_show("AccelHarmonic adaptive", seconds()-t, n);
+	printf("mean degree %.1f, full degree in %.1f%% of the orbit\n", mean/n, 100.0*full/n);
+	
+	free(r);
+	
+	return sum == 0.0;
+}
+
+/** @brief Benchmark of the gravity grid: building, mapping the
+ *  stored grid, and queries against the full 20x20 field.
+ *
+ *  @return 0.
+ */
+int GravGrid_bench() {
+	const char *file = "data/GravGrid_bench.bin";
+	int n = 100000;
+	double t, sum = 0.0;
+	
+	remove(file);
+	t = seconds();
+	GravGrid *g = GravGrid_create(file, 20, 20, 6578e3, 7578e3, 51, 91, 180);
+	printf("\nGravGrid: 20x20, %d x %d x %d nodes, %.1f MB, error %.2e m/s^2\n",
+		   g->nr, g->nlat, g->nlon, g->size/1048576.0, g->err);
+	printf("%-36s %10.3f s\n", "build", seconds()-t);
+	GravGrid_free(g);
+	
+	t = seconds();
+	g = GravGrid_create(file, 20, 20, 6578e3, 7578e3, 51, 91, 180);
+	printf("%-36s %10.3f s\n", "map", seconds()-t);
+	
+	// Points along an inclined circular orbit inside the grid
+	t = seconds();
+	for(int i = 0; i < n; i++) {
+		double u = 1e-4*i;
+		Vec3 r = {{7000e3*cos(u), 3500e3*sin(u), 6062e3*sin(u)}};
+		sum += AccelHarmonic(r, m3_eye(), 20, 20).v[0];
+	}
+	bench_show("AccelHarmonic 20x20", seconds()-t, n);
+	
+	t = seconds();
+	for(int i = 0; i < n; i++) {
+		double u = 1e-4*i;
+		Vec3 r = {{7000e3*cos(u), 3500e3*sin(u), 6062e3*sin(u)}};
+		sum += GravGrid_accel(g, r, m3_eye()).v[0];
+	}
+	bench_show("GravGrid_accel", seconds()-t, n);
+	
+	GravGrid_free(g);
+	remove(file);
+	
+	return sum == 0.0;
+}
+
+/** @brief Benchmark of the loading of GGM03S.txt up to the degrees
+ *  in use and in full.
+ *
+ *  @return 0.
+ */
+int GravModel_bench() {
+	int degree[] = {20, 70, 180}, n = 20;
+	double t, sum = 0.0;
+	char name[64];
+	
+	printf("\n");
+	for(int k = 0; k < 3; k++) {
+		t = seconds();
+		for(int i = 0; i < n; i++) {
+			GravModel *g = GravModel_load("data/GGM03S.txt", degree[k]);
+			sum += GRAV_C(g, 2, 0);
+			GravModel_free(g);
+		}
+		snprintf(name, sizeof(name), "GravModel_load degree %d", degree[k]);
+		bench_show(name, seconds()-t, n);
+	}
+	
+	return sum == 0.0;
+}
+
+// Accel, counting its evaluations
+static long accel_evals = 0;
+
+static void accel_counted(double x, double *Y, double **dY) {
+	accel_evals++;
+	Accel(x, Y, dY);
+}
+
+/** @brief Benchmark of an ephemeris at 1 s over one orbit: landing on
+ *  every output point with ode_advance, and one arc with its dense
+ *  output.
+ *
+ *  @return 0.
+ */
+int ode_arc_bench() {
+	extern Param AuxParam;
+	int n = 6000;
+	double Mjd_UTC = 49746.1101504629, t, sum = 0.0, y[6];
+	const double Y0[6] = {6221397.62857869, 2867713.77965741, 3006155.9850995,
+						  4645.0472516175, -2752.21591588182, -7507.99940986939};
+	char name[64];
+	
+	EarthRot *er = EarthRot_create(Mjd_UTC, Mjd_UTC + 0.1, 1e-10);
+	EarthRot_bind(er);
+	AuxParam.Mjd_UTC = Mjd_UTC;
+	AuxParam.n = 20;
+	AuxParam.m = 20;
+	AuxParam.sun = 1;
+	AuxParam.moon = 1;
+	AuxParam.planets = 1;
+	AuxParam.tol = 0.0;
+	
+	OdeContext *c = ode_create(accel_counted, 6, 1e-13, 1e-6);
+	OdeArc *a = ode_arc_create(6);
+	printf("\n");
+	
+	ode_start(c, 0.0);
+	memcpy(y, Y0, sizeof(y));
+	accel_evals = 0;
+	t = seconds();
+	for(int i = 1; i <= n; i++) {
+		ode_advance(c, y, i);
+		sum += y[0];
+	}
+	snprintf(name, sizeof(name), "ode_advance every 1 s (%ld evals)", accel_evals);
+	bench_show(name, seconds()-t, n);
+	
+	ode_start(c, 0.0);
+	memcpy(y, Y0, sizeof(y));
+	accel_evals = 0;
+	t = seconds();
+	ode_arc(c, y, n, a);
+	for(int i = 1; i <= n; i++) {
+		ode_arc_eval(a, i, y, NULL);
+		sum += y[0];
+	}
+	snprintf(name, sizeof(name), "ode_arc + eval (%ld evals)", accel_evals);
+	bench_show(name, seconds()-t, n);
+	
+	ode_arc_free(a);
+	ode_free(c);
+	EarthRot_bind(NULL);
+	EarthRot_free(er);
+	
+	return sum == 0.0;
+}
+
+// Propagation of an orbit from t = 0 to the output points tk; h is
+// the step of ODE_GAUSS_JACKSON
+static double propagate(int method, double relerr, double abserr, double h,
+						const double *Y0, const double *tk, int n, double *Y) {
+	double t;
+	
+	OdeContext *c = ode_create(accel_counted, 6, relerr, abserr);
+	ode_method(c, method);
+	c->h = h;
+	ode_start(c, 0.0);
+	memcpy(Y, Y0, 6*sizeof(double));
+	accel_evals = 0;
+	t = seconds();
+	for(int i = 0; i < n; i++) {
+		if(i > 0)
+			memcpy(Y+6*i, Y+6*(i-1), 6*sizeof(double));
+		ode_advance(c, Y+6*i, tk[i]);
+	}
+	t = seconds()-t;
+	ode_free(c);
+	
+	return t;
+}
+
+// One method against the reference R: evaluations, also per orbit of
+// period T, time and the largest position error
+static void ode_method_show(int method, double relerr, double h, double T,
+							const double *Y0, const double *tk, int n, const double *R) {
+	const char *names[3] = {"ODE_ADAMS", "ODE_DOP853", "ODE_GJ"};
+	double *Y = (double *) malloc(6*n*sizeof(double));
+	double t, err = 0.0, d;
+	char step[16] = "-";
+	
+	t = propagate(method, relerr, 1e7*relerr, h, Y0, tk, n, Y);
+	for(int i = 0; i < n; i++) {
+		d = sqrt(pow(Y[6*i]-R[6*i],2) + pow(Y[6*i+1]-R[6*i+1],2) + pow(Y[6*i+2]-R[6*i+2],2));
+		err = fmax(err, d);
+	}
+	if(method == ODE_GAUSS_JACKSON)
+		snprintf(step, sizeof(step), "%.0f", h);
+	printf("%-12s %8.0e %6s %8ld %8.0f %12.3f %12.2e\n", names[method], relerr, step,
+		   accel_evals, accel_evals*T/tk[n-1], 1e3*t, err);
+	
+	free(Y);
+}
+
+// The methods over a ladder of tolerances or steps, against a tight reference
+static void ode_methods_show(const char *title, const double *Y0, const double *tk, int n) {
+	double *R = (double *) malloc(6*n*sizeof(double));
+	double r = sqrt(Y0[0]*Y0[0] + Y0[1]*Y0[1] + Y0[2]*Y0[2]);
+	double a = 1.0/(2.0/r - (Y0[3]*Y0[3] + Y0[4]*Y0[4] + Y0[5]*Y0[5])/GM_Earth);
+	double T = pi2*sqrt(a*a*a/GM_Earth);
+	
+	printf("\n%s: %d output points over %.1f h\n", title, n, tk[n-1]/3600.0);
+	printf("%-12s %8s %6s %8s %8s %12s %12s\n", "method", "relerr", "h [s]", "evals",
+		   "/orbit", "time [ms]", "error [m]");
+	propagate(ODE_ADAMS, 1e-14, 1e-8, 0.0, Y0, tk, n, R);
+	for(int m = ODE_ADAMS; m <= ODE_DOP853; m++)
+		for(int e = 8; e <= 13; e++)
+			ode_method_show(m, pow(10.0, -e), 0.0, T, Y0, tk, n, R);
+	for(double h = 120.0; h >= 15.0; h /= 2.0)
+		ode_method_show(ODE_GAUSS_JACKSON, 1e-13, h, T, Y0, tk, n, R);
+	
+	free(R);
+}
+
+/** @brief Benchmark of the integration methods at equal accuracy:
+ *  evaluations, also per orbit, time and the largest position error
+ *  of ODE_ADAMS and ODE_DOP853 for relative tolerances from 1e-8 to
+ *  1e-13 (absolute ones 1e7 times that), and of ODE_GAUSS_JACKSON
+ *  for steps from 120 s to 15 s, on the GEOS3 case (landing on the
+ *  observations, as the filter does) and on a three day propagation
+ *  with an output every hour, with the harmonic field alone.
+ *
+ *  @return 0.
+ */
+int ode_methods_bench() {
+	extern Param AuxParam;
+	double tk[72];
+	int n;
+	const double Y0[6] = {6221397.62857869, 2867713.77965741, 3006155.9850995,
+						  4645.0472516175, -2752.21591588182, -7507.99940986939};
+	double Mjd_UTC = obs[8][0];
+	
+	EarthRot *er = EarthRot_create(Mjd_UTC, Mjd_UTC + 3.1, 1e-10);
+	EarthRot_bind(er);
+	AuxParam.Mjd_UTC = Mjd_UTC;
+	AuxParam.n = 20;
+	AuxParam.m = 20;
+	AuxParam.sun = 1;
+	AuxParam.moon = 1;
+	AuxParam.planets = 1;
+	AuxParam.tol = 0.0;
+	
+	n = 0;
+	for(int i = 9; i < fobs; i++)
+		tk[n++] = (obs[i][0]-Mjd_UTC)*86400.0;
+	ode_methods_show("GEOS3", Y0, tk, n);
+	
+	AuxParam.sun = 0;
+	AuxParam.moon = 0;
+	AuxParam.planets = 0;
+	for(n = 0; n < 72; n++)
+		tk[n] = 3600.0*(n+1);
+	ode_methods_show("Three days", Y0, tk, n);
+	
+	EarthRot_bind(NULL);
+	EarthRot_free(er);
+	
+	return 0;
+}
+
+/** @brief Benchmark of the Chebyshev evaluation: allocating Cheb3D,
+ *  lane kernel for one epoch and for a table of epochs, and the
+ *  ephemerides of all the bodies.
+ *
+ *  @return 0.
+ */
+int Cheb3D_bench() {
+	int n = 200000, N = 13, m = 64;
+	double Cx[13], Cy[13], Cz[13], tk[64], t, sum = 0.0;
+	double *R;
+	Vec3 r, rt[64];
+	
+	for(int i = 0; i < N; i++) {
+		Cx[i] = 1.0/(i+1);
+		Cy[i] = -0.5/(i+1);
+		Cz[i] = 0.25/(i+2);
+	}
+	for(int k = 0; k < m; k++)
+		tk[k] = 4.0*k/(m-1);
+	
+	printf("\nCheb3D: %d coefficients\n", N);
+	
+	t = seconds();
+	for(int i = 0; i < n; i++) {
+		R = Cheb3D(4.0*i/n, N, 0.0, 4.0, Cx, Cy, Cz);
+		sum += R[0];
+		v_free(R,3);
+	}
+	bench_show("Cheb3D", seconds()-t, n);
+	
+	t = seconds();
+	for(int i = 0; i < n; i++) {
+		r = Cheb3D_v3(4.0*i/n, N, 0.0, 4.0, Cx, Cy, Cz);
+		sum += r.v[0];
+	}
+	bench_show("Cheb3D_v3", seconds()-t, n);
+	
+	t = seconds();
+	for(int i = 0; i < n/m; i++) {
+		Cheb3D_batch(m, tk, N, 0.0, 4.0, Cx, Cy, Cz, rt);
+		sum += rt[i%m].v[0];
+	}
+	bench_show("Cheb3D_batch (per epoch)", seconds()-t, n/m*m);
+	
+	double Mjd_TDB = 49746.1108;
+	Vec3 rb[JPL_BODIES];
+	double *rp[JPL_BODIES];
+	n = n/10;
+	
+	t = seconds();
+	for(int i = 0; i < n; i++) {
+		JPL_Eph_DE430(Mjd_TDB + 0.25*i/n, &rp[0], &rp[1], &rp[2], &rp[3], &rp[4],
+					  &rp[5], &rp[6], &rp[7], &rp[8], &rp[9], &rp[10]);
+		sum += rp[10][0];
+		for(int b = 0; b < JPL_BODIES; b++)
+			v_free(rp[b],3);
+	}
+	bench_show("JPL_Eph_DE430", seconds()-t, n);
+	
+	t = seconds();
+	for(int i = 0; i < n; i++) {
+		JPL_Eph_DE430_bodies(Mjd_TDB + 0.25*i/n, (1 << JPL_BODIES) - 1, rb);
+		sum += rb[JPL_SUN].v[0];
+	}
+	bench_show("JPL_Eph_DE430_bodies (all)", seconds()-t, n);
+	
+	return sum == 0.0;
+}
+
+/** @brief Run all the benchmarks.
+ *
+ *  @return 0.
+ */
+int all_benches() {
+	EarthRot_bench();
+	AccelHarmonic_bench();
+	AccelHarmonic_batch_bench();
+	AccelHarmonic_degree_bench();
+	GravGrid_bench();
+	GravModel_bench();
+	ode_arc_bench();
+	ode_methods_bench();
+	Cheb3D_bench();
+	
+	return 0;
+}
+
+
+//int main()
+//{
+//	DE430Coeff(2285,1020);
+//	GGM03S(181);
+//	eop19620101(21413);
+//	GEOS3(46);
+//
+//	return all_benches();
+//}
@@ -15,6 +15,8 @@
 #ifndef _ACCEL_
 #define _ACCEL_
 
+#include "m_fixed.h"
+
 
 /** @brief Acceleration of an Earth orbiting satellite.
  *
@@ -24,5 +26,19 @@
  */
 void Accel(double x, double *Y, double **dY);
 
+/** @brief Acceleration of an Earth orbiting satellite and, on
+ *  request, the gradient of its harmonic part, from the same Earth
+ *  orientation, ephemerides and recursion. With the gradient the
+ *  harmonic part is always evaluated in full, to AuxParam.n and
+ *  AuxParam.m, whether a grid is bound or the degree is adaptive,
+ *  and counted in AccelHarmonic_uses(AuxParam.n).
+ *
+ *  @param [in] x Time since AuxParam.Mjd_UTC [s].
+ *  @param [in] r Satellite position vector in the ICRF/EME2000 system.
+ *  @param [out] G Gradient da/dr of the harmonic field, or NULL.
+ *  @return Acceleration (a=d^2r/dt^2) in the ICRF/EME2000 system.
+ */
+Vec3 Accel_gradient(double x, Vec3 r, Mat3 *G);
+
 
 #endif
@@ -13,17 +13,107 @@
 #ifndef _ACCELHARMONIC_
 #define _ACCELHARMONIC_
 
+#include "m_fixed.h"
+
+
+/** @brief Engines of AccelHarmonic. */
+#define HARMONIC_LEGENDRE   0   // Geocentric latitude and longitude; singular at the poles
+#define HARMONIC_CUNNINGHAM 1   // Body-fixed Cartesian V/W recursions; no trigonometry
+
+/** @brief Satellites evaluated in lock-step by AccelHarmonic_batch. */
+#define HARMONIC_LANES 4
+
+/** @brief Highest degree counted by AccelHarmonic_uses. */
+#define HARMONIC_MAX_DEGREE 360
+
 
 /** @brief Acceleration due to the harmonic gravity field of the 
  *  central body.
  *
+ *  The field is evaluated by the engine selected with
+ *  AccelHarmonic_engine, HARMONIC_LEGENDRE by default.
+ *
  *  @param [in] r Satellite position vector in the inertial system.
  *  @param [in] E Transformation matrix to body-fixed system.
  *  @param [in] n_max Maximum degree.
  *  @param [in] m_max Maximum order (m_max<=n_max; m_max=0 for zonals, only).
  *  @return Acceleration (a=d^2r/dt^2).
  */
-double *AccelHarmonic(double *r, double **E, int n_max, int m_max);
+Vec3 AccelHarmonic(Vec3 r, Mat3 E, int n_max, int m_max);
+
+/** @brief Select the engine of AccelHarmonic at run time.
+ *
+ *  HARMONIC_CUNNINGHAM works in body-fixed Cartesian coordinates,
+ *  stays finite over the poles and is the faster one at high degree.
+ *
+ *  @param [in] engine HARMONIC_LEGENDRE or HARMONIC_CUNNINGHAM.
+ *  @return Previous engine.
+ */
+int AccelHarmonic_engine(int engine);
+
+/** @brief Body-fixed acceleration due to the harmonic gravity field
+ *  for a batch of satellites, in structure-of-arrays form.
+ *
+ *  The batch follows the HARMONIC_LEGENDRE mathematics: the
+ *  Legendre recursion and the harmonic sums advance HARMONIC_LANES
+ *  satellites in lock-step, so every coefficient is loaded once per
+ *  block of satellites. Each result is the same as AccelHarmonic
+ *  with the identity as transformation.
+ *
+ *  @param [in] N Number of satellites.
+ *  @param [in] x Body-fixed x coordinates (N).
+ *  @param [in] y Body-fixed y coordinates (N).
+ *  @param [in] z Body-fixed z coordinates (N).
+ *  @param [in] n_max Maximum degree.
+ *  @param [in] m_max Maximum order (m_max<=n_max; m_max=0 for zonals, only).
+ *  @param [out] ax Body-fixed x accelerations (N).
+ *  @param [out] ay Body-fixed y accelerations (N).
+ *  @param [out] az Body-fixed z accelerations (N).
+ */
+void AccelHarmonic_batch(int N, const double *x, const double *y, const double *z,
+						 int n_max, int m_max, double *ax, double *ay, double *az);
+
+/** @brief Smallest degree whose omitted acceleration stays below a
+ *  tolerance at a distance.
+ *
+ *  The acceleration of degree n is bounded anywhere on the sphere by
+ *  GM/d^2*(2n+1)*sqrt(n+1)*(R/d)^n*sqrt(sum_m(Cnm^2+Snm^2)), from the
+ *  Cauchy-Schwarz inequality and the addition theorem of the fully
+ *  normalized harmonics, and the bounds of the degrees above the
+ *  result up to n_max add up to at most tol. The omitted
+ *  acceleration is then below tol; it is typically a few times
+ *  smaller.
+ *  Since the terms fall off as (R/d)^n, the degree drops with the
+ *  altitude.
+ *
+ *  @param [in] d Distance to the Earth's center [m].
+ *  @param [in] n_max Maximum degree.
+ *  @param [in] tol Tolerance [m/s^2].
+ *  @return Degree (0<=n<=n_max).
+ */
+int AccelHarmonic_degree(double d, int n_max, double tol);
+
+/** @brief Number of evaluations of AccelHarmonic and
+ *  AccelHarmonic_batch (one per satellite) made with a degree,
+ *  with those counted by AccelHarmonic_count.
+ *
+ *  @param [in] n Degree (0<=n<=HARMONIC_MAX_DEGREE).
+ *  @return Number of evaluations.
+ */
+long AccelHarmonic_uses(int n);
+
+/** @brief Count evaluations of the field made with a degree outside
+ *  AccelHarmonic, as those of Cunningham with the gradient.
+ *
+ *  @param [in] n Degree.
+ *  @param [in] k Number of evaluations.
+ */
+void AccelHarmonic_count(int n, long k);
+
+/** @brief Console printing of the number of evaluations made with
+ *  every degree used.
+ */
+void AccelHarmonic_report(void);
 
 
 #endif
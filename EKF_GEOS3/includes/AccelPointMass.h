@@ -12,6 +12,8 @@
 #ifndef _ACCELPOINTMASS_
 #define _ACCELPOINTMASS_
 
+#include "m_fixed.h"
+
 
 /** @brief Perturbational acceleration due to a point mass.
  *
@@ -20,7 +22,7 @@
  *  @param [in] GM Gravitational coefficient of point mass.
  *  @return Acceleration (a=d^2r/dt^2).
  */
-double *AccelPointMass(double *r, double *s, double GM);
+Vec3 AccelPointMass(Vec3 r, Vec3 s, double GM);
 
 
 #endif
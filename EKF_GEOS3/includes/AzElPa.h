@@ -19,10 +19,10 @@
  *  @param [in] s Topocentric local tangent coordinates (East-North-Zenith frame).
  *  @param [out] A Azimuth [rad].
  *  @param [out] E Elevation [rad].
- *  @param [out] dAds Partials of azimuth w.r.t. s.
- *  @param [out] dEds Partials of elevation w.r.t. s.
+ *  @param [out] dAds Partials of azimuth w.r.t. s (3 components, caller-owned).
+ *  @param [out] dEds Partials of elevation w.r.t. s (3 components, caller-owned).
  */
-void AzElPa(double *s, double *Az, double *El, double **dAds, double **dEds);
+void AzElPa(double *s, double *Az, double *El, double *dAds, double *dEds);
 
 
 #endif
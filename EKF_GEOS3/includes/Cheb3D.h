@@ -12,6 +12,26 @@
 #ifndef _CHEB3D_
 #define _CHEB3D_
 
+#include "m_fixed.h"
+
+/** @brief Number of series evaluated together by the Clenshaw kernel
+ *  (the four doubles of an AVX2 register). */
+#define CHEB_LANES  4
+
+
+/** @brief Chebyshev series evaluated in lanes: several series,
+ *  each with its own normalized time and number of coefficients,
+ *  go through a single Clenshaw recursion, CHEB_LANES at a time.
+ *  Vectorized with AVX2 when the compiler targets it. No
+ *  allocation.
+ *
+ *  @param [in] n Number of series.
+ *  @param [in] N Number of coefficients of each series.
+ *  @param [in] tau Normalized time of each series, in [-1,1].
+ *  @param [in] C Coefficients of each series.
+ *  @param [out] f Value of each series.
+ */
+void Cheb_lanes(int n, const int *N, const double *tau, double *const *C, double *f);
 
 /** @brief Chebyshev approximation of 3-dimensional vectors.
  *
@@ -26,5 +46,35 @@
  */
 double *Cheb3D(double t, int N, double Ta, double Tb, double *Cx, double *Cy, double *Cz);
 
+/** @brief Chebyshev approximation of 3-dimensional vectors, without
+ *  allocation.
+ *
+ *  @param [in] t Initial value.
+ *  @param [in] N Number of coefficients.
+ *  @param [in] Ta Begin interval.
+ *  @param [in] Tb End interval.
+ *  @param [in] Cx Coefficients of Chebyshev polyomial (x-coordinate).
+ *  @param [in] Cy Coefficients of Chebyshev polyomial (y-coordinate).
+ *  @param [in] Cz Coefficients of Chebyshev polyomial (z-coordinate).
+ *  @return Chebyshev approximation.
+ */
+Vec3 Cheb3D_v3(double t, int N, double Ta, double Tb, double *Cx, double *Cy, double *Cz);
+
+/** @brief Chebyshev approximation of 3-dimensional vectors at many
+ *  epochs of the same interval (ephemeris tables), without
+ *  allocation. The epochs are evaluated CHEB_LANES at a time.
+ *
+ *  @param [in] m Number of epochs.
+ *  @param [in] t Epochs.
+ *  @param [in] N Number of coefficients.
+ *  @param [in] Ta Begin interval.
+ *  @param [in] Tb End interval.
+ *  @param [in] Cx Coefficients of Chebyshev polyomial (x-coordinate).
+ *  @param [in] Cy Coefficients of Chebyshev polyomial (y-coordinate).
+ *  @param [in] Cz Coefficients of Chebyshev polyomial (z-coordinate).
+ *  @param [out] r Chebyshev approximation at each epoch.
+ */
+void Cheb3D_batch(int m, const double *t, int N, double Ta, double Tb, double *Cx, double *Cy, double *Cz, Vec3 *r);
+
 
 #endif
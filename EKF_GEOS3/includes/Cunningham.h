@@ -0,0 +1,35 @@
+/** @file Cunningham.h
+ *  @brief Function prototypes for the acceleration and gradient of
+ *  the harmonic gravity field by the Cunningham recursions.
+ *
+ *  This header file contains the prototypes for the computation of
+ *  the acceleration due to the harmonic gravity field of the central
+ *  body, and of its gradient, from the fully normalized Cunningham
+ *  V/W functions. The recursions work on the body-fixed Cartesian
+ *  coordinates, so they have no singularity at the poles. One pass
+ *  up to degree n_max+2 gives both the acceleration and the gradient.
+ *
+ *  @author Miguel Alonso Angulo.
+ *  @bug No known bugs.
+ */
+
+#ifndef _CUNNINGHAM_
+#define _CUNNINGHAM_
+
+#include "m_fixed.h"
+
+
+/** @brief Acceleration due to the harmonic gravity field of the
+ *  central body and, optionally, its gradient.
+ *
+ *  @param [in] r Satellite position vector in the inertial system.
+ *  @param [in] E Transformation matrix to body-fixed system.
+ *  @param [in] n_max Maximum degree.
+ *  @param [in] m_max Maximum order (m_max<=n_max; m_max=0 for zonals, only).
+ *  @param [out] G Gradient (G=da/dr) in the inertial system, or NULL.
+ *  @return Acceleration (a=d^2r/dt^2).
+ */
+Vec3 Cunningham(Vec3 r, Mat3 E, int n_max, int m_max, Mat3 *G);
+
+
+#endif
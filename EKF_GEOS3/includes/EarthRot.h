@@ -0,0 +1,84 @@
+/** @file EarthRot.h
+ *  @brief Function prototypes for the Earth rotation provider.
+ *
+ *  This header file contains the prototypes for the Earth rotation
+ *  provider. For an integration arc it tabulates the
+ *  precession-nutation matrix and the equation of the equinoxes at
+ *  equally spaced nodes, and serves them by cubic interpolation. The
+ *  fast Earth rotation angle (GMST) is always evaluated exactly. The
+ *  node spacing is halved until the interpolation error, measured at
+ *  the middle of every interval, is below the requested bound.
+ *
+ *  Accel, VarEqn and anglesg use the bound provider, if any; with no
+ *  provider bound, or outside its arc, they compute the exact values.
+ *
+ *  @author Miguel Alonso Angulo.
+ *  @bug No known bugs.
+ */
+
+#ifndef _EARTHROT_
+#define _EARTHROT_
+
+#include "m_fixed.h"
+
+
+/** @brief Earth rotation provider for one arc. */
+typedef struct {
+	double t0;      // Epoch of the first node [MJD]
+	double h;       // Node spacing [days]
+	int n;          // Number of nodes
+	double *node;   // N*P (9, row-major) and equation of the equinoxes per node
+	double tol;     // Requested accuracy [rad]
+	double err;     // Largest interpolation error found [rad]
+} EarthRot;
+
+
+
+/** @brief Creating an Earth rotation provider.
+ *
+ *  @param [in] Mjd_first Start of the arc [MJD].
+ *  @param [in] Mjd_last End of the arc [MJD].
+ *  @param [in] tol Accuracy of the interpolated matrices [rad].
+ *  @return Provider.
+ */
+EarthRot *EarthRot_create(double Mjd_first, double Mjd_last, double tol);
+
+/** @brief Release an Earth rotation provider.
+ *
+ *  @param [in] er Provider.
+ */
+void EarthRot_free(EarthRot *er);
+
+/** @brief Transformation from ICRF to the true equator and equinox
+ *  of date (NutMatrix*PrecMatrix).
+ *
+ *  @param [in] er Provider, or NULL for the exact matrix.
+ *  @param [in] Mjd_TT Modified Julian Date TT.
+ *  @return Precession-nutation matrix.
+ */
+Mat3 EarthRot_NP(EarthRot *er, double Mjd_TT);
+
+/** @brief Transformation from true equator and equinox to Earth
+ *  equator and Greenwich meridian system (GHAMatrix).
+ *
+ *  @param [in] er Provider, or NULL for the exact matrix.
+ *  @param [in] Mjd_UT1 Modified Julian Date UT1.
+ *  @return Greenwich Hour Angle matrix.
+ */
+Mat3 EarthRot_GHA(EarthRot *er, double Mjd_UT1);
+
+/** @brief Bind a provider for Accel, VarEqn and anglesg.
+ *
+ *  @param [in] er Provider, or NULL for the exact matrices.
+ *  @return Previously bound provider.
+ */
+EarthRot *EarthRot_bind(EarthRot *er);
+
+/** @brief Provider currently bound.
+ *
+ *  @return Provider, or NULL.
+ */
+EarthRot *EarthRot_current(void);
+
+
+#endif
@@ -14,6 +14,8 @@
 #ifndef _GHAMATRIX_
 #define _GHAMATRIX_
 
+#include "m_fixed.h"
+
 
 /** @brief Transformation from true equator and equinox to Earth 
  *  equator and Greenwich meridian system.
@@ -21,7 +23,7 @@
  *  @param [in] Mjd_UT1 Modified Julian Date UT1.
  *  @return Greenwich Hour Angle matrix.
  */
-double **GHAMatrix(double Mjd_UT1);
+Mat3 GHAMatrix(double Mjd_UT1);
 
 
 #endif
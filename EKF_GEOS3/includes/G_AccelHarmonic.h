@@ -12,6 +12,8 @@
 #ifndef _G_ACCELHARMONIC_
 #define _G_ACCELHARMONIC_
 
+#include "m_fixed.h"
+
 
 /** @brief Gradient of the Earth's harmonic gravity field.
  *
@@ -21,7 +23,7 @@
  *  @param [in] m_max Gravity model order.
  *  @return Gradient (G=da/dr) in the true-of-date system.
  */
-double **G_AccelHarmonic(double *r, double **U, int n_max, int m_max);
+Mat3 G_AccelHarmonic(Vec3 r, Mat3 U, int n_max, int m_max);
 
 
 #endif
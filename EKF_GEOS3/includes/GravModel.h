@@ -0,0 +1,92 @@
+/** @file GravModel.h
+ *  @brief Function prototypes for the gravity field model.
+ *
+ *  This header file contains the prototypes for the gravity field
+ *  model: the fully normalized coefficients Cnm and Snm up to a
+ *  maximum degree, with the gravitational coefficient and the
+ *  reference radius they refer to. The coefficients are stored
+ *  interleaved in one flat triangular array (LEG_NM), aligned for
+ *  SIMD loads, so that a pass over degrees and orders reads them in
+ *  order and Cnm and Snm share a cache line.
+ *
+ *  The harmonic gravity routines (AccelHarmonic, Cunningham,
+ *  GravGrid) use the bound model, which GGM03S loads and binds.
+ *
+ *  @author Miguel Alonso Angulo.
+ *  @bug No known bugs.
+ */
+
+#ifndef _GRAVMODEL_
+#define _GRAVMODEL_
+
+#include "Legendre.h"
+
+
+/** @brief Alignment of the coefficients [bytes]. */
+#define GRAV_ALIGN 64
+
+/** @brief Cnm of a model. */
+#define GRAV_C(g,n,m)  ((g)->cs[2*LEG_NM(n,m)])
+
+/** @brief Snm of a model. */
+#define GRAV_S(g,n,m)  ((g)->cs[2*LEG_NM(n,m)+1])
+
+/** @brief Gravity field model. */
+typedef struct {
+	int n;          // Maximum degree
+	double gm;      // Gravitational coefficient [m^3/s^2]
+	double r_ref;   // Reference radius [m]
+	double *cs;     // Cnm and Snm interleaved per (n,m), flat triangular
+	void *block;    // Allocation cs is aligned within
+} GravModel;
+
+
+
+/** @brief Load a gravity field model up to a degree.
+ *
+ *  The file has one row per coefficient, "n m Cnm Snm ..." as in
+ *  GGM03S.txt, or "gfc n m Cnm Snm ..." as in the ICGEM .gfc files,
+ *  whose earth_gravity_constant and radius header entries are read
+ *  too (otherwise those of GGM03S are taken). The rows may come in
+ *  any order, rows above n_max are skipped, and the numbers may have
+ *  Fortran exponents (1.0D-06). Every coefficient up to n_max must be
+ *  in the file.
+ *
+ *  @param [in] file Model file.
+ *  @param [in] n_max Maximum degree.
+ *  @return Model.
+ */
+GravModel *GravModel_load(const char *file, int n_max);
+
+/** @brief Release a gravity field model. If it is the bound one,
+ *  no model is bound afterwards.
+ *
+ *  @param [in] g Model.
+ */
+void GravModel_free(GravModel *g);
+
+/** @brief Bind a model for the harmonic gravity routines.
+ *
+ *  @param [in] g Model.
+ *  @return Previously bound model.
+ */
+GravModel *GravModel_bind(GravModel *g);
+
+/** @brief Model currently bound.
+ *
+ *  @return Model, or NULL.
+ */
+GravModel *GravModel_current(void);
+
+/** @brief Generation of the bound model.
+ *
+ *  It changes on every load and bind, so that the tables built from
+ *  a model are keyed on it rather than on the model address, which a
+ *  later model may reuse.
+ *
+ *  @return Generation.
+ */
+long GravModel_generation(void);
+
+
+#endif
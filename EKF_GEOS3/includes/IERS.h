@@ -13,6 +13,28 @@
 #define _IERS_
 
 
+/** @brief Earth orientation parameters at an epoch. */
+typedef struct {
+	double x_pole, y_pole;    // Pole coordinates [rad]
+	double UT1_UTC;           // UT1-UTC time difference [s]
+	double LOD;               // Length of day [s]
+	double dpsi, deps;        // Nutation corrections [rad]
+	double dx_pole, dy_pole;  // Pole coordinates [rad]
+	double TAI_UTC;           // TAI-UTC time difference [s]
+} EOP;
+
+
+/** @brief IERS time and polar motion data, without allocation.
+ *  The day is found by its offset from the first day of eopdata,
+ *  which must be a daily series.
+ *
+ *  @param [in] Mjd_UTC Modified Julian Date UTC.
+ *  @param [in] interp 'l' for linear interpolation, 'n' for the
+ *  values of the day.
+ *  @param [out] eop Earth orientation parameters.
+ */
+void IERS_eop(double Mjd_UTC, char interp, EOP *eop);
+
 /** @brief IERS time and polar motion data.
  *
  *  @param [in] Mjd_UTC Modified Julian Date UTC.
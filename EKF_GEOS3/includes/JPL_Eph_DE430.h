@@ -12,6 +12,24 @@
 #ifndef _JPL_
 #define _JPL_
 
+#include "m_fixed.h"
+
+
+/** @brief Bodies of the ephemerides, as indices of the position
+ *  array of JPL_Eph_DE430_bodies. */
+enum {
+	JPL_MERCURY, JPL_VENUS, JPL_EARTH, JPL_MARS, JPL_JUPITER, JPL_SATURN,
+	JPL_URANUS, JPL_NEPTUNE, JPL_PLUTO, JPL_MOON, JPL_SUN, JPL_BODIES
+};
+
+/** @brief Mask bit of a body. */
+#define JPL_MASK(body)  (1 << (body))
+
+/** @brief Mask of the eight planets other than the Earth. */
+#define JPL_PLANETS     (JPL_MASK(JPL_MERCURY) | JPL_MASK(JPL_VENUS) | JPL_MASK(JPL_MARS) | \
+						 JPL_MASK(JPL_JUPITER) | JPL_MASK(JPL_SATURN) | JPL_MASK(JPL_URANUS) | \
+						 JPL_MASK(JPL_NEPTUNE) | JPL_MASK(JPL_PLUTO))
+
 
 /** @brief Sun, moon, and nine major planets' equatorial position using JPL Ephemerides.
  *
@@ -33,5 +51,25 @@ void JPL_Eph_DE430(double Mjd_TDB, double **r_Mercury, double **r_Venus,
 				   double **r_Saturn, double **r_Uranus, double **r_Neptune,
 				   double **r_Pluto, double **r_Moon, double **r_Sun);
 
+/** @brief Equatorial position of the requested bodies using JPL
+ *  Ephemerides, without allocation. Only the Chebyshev series of
+ *  the bodies in the mask are evaluated (plus the Earth-Moon
+ *  barycenter and the Moon when another body needs them).
+ *
+ *  @param [in] Mjd_TDB Modified julian date of TDB.
+ *  @param [in] mask Requested bodies (JPL_MASK bits).
+ *  @param [out] r Positions, indexed by body; entries of bodies
+ *  not in the mask are left untouched.
+ */
+void JPL_Eph_DE430_bodies(double Mjd_TDB, int mask, Vec3 *r);
+
+/** @brief Equatorial position of one body using JPL Ephemerides.
+ *
+ *  @param [in] Mjd_TDB Modified julian date of TDB.
+ *  @param [in] body Body (JPL_SUN, JPL_MOON, ...).
+ *  @return Position.
+ */
+Vec3 JPL_Eph_DE430_body(double Mjd_TDB, int body);
+
 
 #endif
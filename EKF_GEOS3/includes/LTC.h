@@ -13,6 +13,8 @@
 #ifndef _LTC_
 #define _LTC_
 
+#include "m_fixed.h"
+
 
 /** @brief Transformation from Greenwich meridian system to 
  *  local tangent coordinates.
@@ -22,7 +24,7 @@
  *  @return Rotation matrix from the Earth equator and Greenwich meridian
  *  to the local tangent (East-North-Zenith) coordinate system.
  */
-double **LTC(double lon, double lat);
+Mat3 LTC(double lon, double lat);
 
 
 #endif
@@ -13,6 +13,28 @@
 #define _LEGENDRE_
 
 
+/** @brief Index of degree n and order m (m <= n) in a flat
+ *  triangular array. */
+#define LEG_NM(n,m)  ((n)*((n)+1)/2+(m))
+
+/** @brief Legendre engine for a maximum degree and order. The
+ *  normalization and recursion factors are computed once, and
+ *  every evaluation overwrites pnm and dpnm. All the per (n,m)
+ *  arrays are flat triangular (LEG_NM); orders above m are zero. */
+typedef struct {
+	int n;          // Maximum degree
+	int m;          // Maximum order
+	double *diag;   // sqrt((2i+1)/(2i)) per degree (sqrt(3) for degree 1)
+	double *sub;    // sqrt(2i+1) per degree
+	double *b;      // sqrt(2i-1) per degree
+	double *a;      // sqrt((2i+1)/((i-j)*(i+j))) per (i,j)
+	double *c;      // sqrt(((i+j-1)*(i-j-1))/(2i-3)) per (i,j)
+	double *pnm;    // Legendre coefficients of the last evaluation
+	double *dpnm;   // Derivatives of the last evaluation
+} LegendreEngine;
+
+
+
 /** @brief Legendre coefficients.
  *
  *  @param [in] n Rows.
@@ -23,5 +45,38 @@
  */
 void Legendre(int n, int m, double fi, double ***pnm, double ***dpnm);
 
+/** @brief Creating a Legendre engine.
+ *
+ *  @param [in] n Maximum degree.
+ *  @param [in] m Maximum order.
+ *  @return Engine.
+ */
+LegendreEngine *Legendre_create(int n, int m);
+
+/** @brief Release a Legendre engine.
+ *
+ *  @param [in] le Engine.
+ */
+void Legendre_free(LegendreEngine *le);
+
+/** @brief Legendre coefficients and their derivatives at an angle,
+ *  into le->pnm and le->dpnm, without allocation.
+ *
+ *  @param [in] le Engine.
+ *  @param [in] fi Angle [rad].
+ */
+void Legendre_eval(LegendreEngine *le, double fi);
+
+/** @brief Legendre_eval truncated at a lower degree and order; the
+ *  recursion factors do not depend on the maximum degree, so the
+ *  values are those of an engine created for n, m.
+ *
+ *  @param [in] le Engine.
+ *  @param [in] fi Angle [rad].
+ *  @param [in] n Degree (n<=le->n).
+ *  @param [in] m Order (m<=le->m).
+ */
+void Legendre_eval_nm(LegendreEngine *le, double fi, int n, int m);
+
 
 #endif
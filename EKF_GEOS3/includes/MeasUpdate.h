@@ -19,12 +19,11 @@
  *  @param [in] g Scalar.
  *  @param [in] s Scalar.
  *  @param [in] G Vector (6 components).
- *  @param [out] K Vector (6 components).
- *  @param [in,out] x Vector (6 components).
- *  @param [in,out] P Matrix 6x6.
- *  @return GAST in [rad].
+ *  @param [out] K Vector (6 components), caller-owned.
+ *  @param [in,out] x Vector (6 components), updated in place.
+ *  @param [in,out] P Matrix 6x6, updated in place.
  */
-void MeasUpdate(double z, double g, double s, double *G, double **K, double **x, double ***P);
+void MeasUpdate(double z, double g, double s, double *G, double *K, double *x, double **P);
 
 
 #endif
@@ -12,13 +12,15 @@
 #ifndef _NUTMATRIX_
 #define _NUTMATRIX_
 
+#include "m_fixed.h"
+
 
 /** @brief Transformation from mean to true equator and equinox.
  *
  *  @param [in] Mjd_TT Modified Julian Date (Terrestrial Time).
  *  @return Nutation matrix.
  */
-double **NutMatrix(double Mjd_TT);
+Mat3 NutMatrix(double Mjd_TT);
 
 
 #endif
@@ -12,6 +12,8 @@
 #ifndef _POLEMATRIX_
 #define _POLEMATRIX_
 
+#include "m_fixed.h"
+
 
 /** @brief Pseudo Earth-fixed to Earth-fixed coordinates for a given date.
  *
@@ -19,7 +21,7 @@
  *  @param [in] yp Pole coordinate.
  *  @return Pole Matrix.
  */
-double **PoleMatrix(double xp, double yp);
+Mat3 PoleMatrix(double xp, double yp);
 
 
 #endif
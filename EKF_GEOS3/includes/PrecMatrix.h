@@ -12,6 +12,8 @@
 #ifndef _PRECMATRIX_
 #define _PRECMATRIX_
 
+#include "m_fixed.h"
+
 
 /** @brief Precession transformation of equatorial coordinates.
  *
@@ -19,7 +21,7 @@
  *  @param [in] Mjd_2 Epoch to precess to (Modified Julian Date TT).
  *  @return Precession transformation matrix.
  */
-double **PrecMatrix(double Mjd_1, double Mjd_2);
+Mat3 PrecMatrix(double Mjd_1, double Mjd_2);
 
 
 #endif
@@ -11,13 +11,15 @@
 #ifndef _RX_
 #define _RX_
 
+#include "m_fixed.h"
+
 
 /** @brief Vector rotation about x axis.
  *
  *  @param [in] c angle of rotation [rad].
  *  @return Vector result.
  */
-double **R_x(double angle);
+Mat3 R_x(double angle);
 
 
 #endif
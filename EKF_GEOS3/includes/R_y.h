@@ -11,13 +11,15 @@
 #ifndef _RY_
 #define _RY_
 
+#include "m_fixed.h"
+
 
 /** @brief Vector rotation about y axis.
  *
  *  @param [in] c angle of rotation [rad].
  *  @return Vector result.
  */
-double **R_y(double angle);
+Mat3 R_y(double angle);
 
 
 #endif
@@ -11,13 +11,15 @@
 #ifndef _RZ_
 #define _RZ_
 
+#include "m_fixed.h"
+
 
 /** @brief Vector rotation about z axis.
  *
  *  @param [in] c angle of rotation [rad].
  *  @return Vector result.
  */
-double **R_z(double angle);
+Mat3 R_z(double angle);
 
 
 #endif
@@ -13,14 +13,14 @@
 #define _TIMEUPDATE_
 
 
-/** @brief Time updater.
+/** @brief Time updater (P = Phi*P*Phi^T + Qdt), in place and
+ *  without allocation.
  *
- *  @param [in] P Matrix 6x6.
+ *  @param [in,out] P Matrix 6x6.
  *  @param [in] Phi Matrix 6x6.
  *  @param [in] Qdt Matrix 6x6.
- *  @return Matrix 6x6.
  */
-double **TimeUpdate(double **P, double **Phi, double **Qdt);
+void TimeUpdate(double **P, double **Phi, double **Qdt);
 
 
 #endif
@@ -23,5 +23,16 @@
  */
 void VarEqn(double x, double *yPhi, double **yPhip);
 
+/** @brief Variational equations with the full force model (Accel)
+ *  driving the state and the gradient of the harmonic field the
+ *  state transition matrix, so that one integration propagates both.
+ *
+ *  @param [in] x Time since epoch in [s].
+ *  @param [in] yPhi (6+36)-dim vector comprising the state vector (y) and
+ *  the state transition matrix (Phi) in column wise storage order.
+ *  @param [out] yPhip Derivative of yPhi.
+ */
+void VarEqn_full(double x, double *yPhi, double **yPhip);
+
 
 #endif
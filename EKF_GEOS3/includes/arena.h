@@ -0,0 +1,104 @@
+/** @file arena.h
+ *  @brief Function prototypes for the arena allocator.
+ *
+ *  This header file contains the prototypes for the bump-pointer
+ *  arena allocator. While an arena is bound, v_create and m_create
+ *  draw their storage from it instead of the heap, and v_free and
+ *  m_free leave it untouched. The ode driver releases everything
+ *  allocated during one evaluation of the right-hand side once the
+ *  derivative has been copied out, so the temporaries of Accel,
+ *  VarEqn, AccelHarmonic and Legendre no longer reach malloc.
+ *
+ *  @author Miguel Alonso Angulo.
+ *  @bug No known bugs.
+ */
+
+#ifndef _ARENA_
+#define _ARENA_
+
+#include <stddef.h>
+
+
+/** @brief Bump-pointer arena. */
+typedef struct {
+	char *base;     // Storage
+	size_t size;    // Capacity [bytes]
+	size_t used;    // Bytes in use
+	size_t peak;    // Highest value reached by used [bytes]
+} Arena;
+
+
+
+/** @brief Creating an arena of a given capacity.
+ *
+ *  @param [in] size Capacity in bytes.
+ *  @return Arena.
+ */
+Arena *arena_create(size_t size);
+
+/** @brief Release an arena and its storage.
+ *
+ *  @param [in] a Arena.
+ */
+void arena_free(Arena *a);
+
+/** @brief Allocate zero-initialised storage from an arena.
+ *
+ *  @param [in] a Arena.
+ *  @param [in] bytes Number of bytes.
+ *  @return Pointer to the storage, aligned to 16 bytes.
+ */
+void *arena_alloc(Arena *a, size_t bytes);
+
+/** @brief Current position of an arena, to be passed to
+ *  arena_release.
+ *
+ *  @param [in] a Arena.
+ *  @return Mark.
+ */
+size_t arena_mark(Arena *a);
+
+/** @brief Release everything allocated from an arena after a mark.
+ *
+ *  @param [in] a Arena.
+ *  @param [in] mark Mark returned by arena_mark.
+ */
+void arena_release(Arena *a, size_t mark);
+
+/** @brief Release everything allocated from an arena.
+ *
+ *  @param [in] a Arena.
+ */
+void arena_reset(Arena *a);
+
+/** @brief Highest number of bytes used by an arena since it was
+ *  created.
+ *
+ *  @param [in] a Arena.
+ *  @return Peak size [bytes].
+ */
+size_t arena_peak(Arena *a);
+
+/** @brief Check whether a pointer belongs to an arena.
+ *
+ *  @param [in] a Arena.
+ *  @param [in] p Pointer.
+ *  @return 1 if p lies in the storage of a, 0 otherwise.
+ */
+int arena_owns(Arena *a, void *p);
+
+/** @brief Bind an arena as the storage of v_create and m_create.
+ *
+ *  @param [in] a Arena, or NULL to go back to the heap.
+ *  @return Previously bound arena.
+ */
+Arena *arena_bind(Arena *a);
+
+/** @brief Arena currently bound.
+ *
+ *  @return Arena, or NULL if allocations go to the heap.
+ */
+Arena *arena_current(void);
+
+
+#endif
@@ -17,26 +17,48 @@ typedef struct {
 	double Mjd_UTC;
 	int n, m, sun, moon, planets;
 	double Mjd_TT;
+	double tol;       // Omitted gravity tolerance of the adaptive degree [m/s^2]; 0 = fixed n, m
 } Param;
 
+/** @brief Header of the binary cache of the DE430 coefficients
+ *  (data/DE430Coeff.bin). It is followed by records*coeffs doubles
+ *  in row-major order, one record per row as in DE430Coeff.txt.
+ */
+typedef struct {
+	char magic[8];    // "DE430BIN"
+	int records;      // Number of records
+	int coeffs;       // Coefficients per record
+	double jd_first;  // Start of the first record [JD]
+	double jd_last;   // End of the last record [JD]
+} DE430Header;
 
-double **PC, **Cnm, **Snm, **eopdata, **obs;
-int fPC, cPC, fCnm, cCnm, fSnm, cSnm, feopdata, ceopdata, fobs, cobs;
+
+double **PC, **eopdata, **obs;
+int fPC, cPC, feopdata, ceopdata, fobs, cobs;
 int n_eqn;
 Param AuxParam;
 
 
-/** @brief Read the GGM03S.txt file and store it in the matrix PC.
+/** @brief Read the DE430Coeff.txt file and store it in the matrix PC.
+ *
+ *  The first run converts the text file into data/DE430Coeff.bin;
+ *  later runs map that file read-only where mmap exists, and PC
+ *  indexes it in place, so PC must not be written; elsewhere (MinGW)
+ *  they read it into PC. The cache is rebuilt when it does not match
+ *  f and c or is older than the text file.
  *  
  *  @param [in] f Number of rows.
  *  @param [in] c Number of columns.
  */
 void DE430Coeff(int f, int c);
 
-/** @brief Read the GGM03S.txt file and store it in the Cnm and Snm
- *  matrices.
+/** @brief Read the GGM03S.txt file up to degree n-1 into a gravity
+ *  model (GravModel) and bind it, releasing the model bound before.
+ *  Only the rows up to that degree are read, so loading the degrees
+ *  in use is much faster than loading the whole file.
  *  
- *  @param [in] n Matrix order.
+ *  @param [in] n Number of degrees (0..n-1; n<=181, the file ends
+ *  at degree 180).
  */
 void GGM03S(int n);
 
@@ -0,0 +1,168 @@
+/** @file m_fixed.h
+ *  @brief Function prototypes for the fixed-size vector and
+ *  matrix utilities.
+ *
+ *  This header file contains the prototypes for the fixed-size
+ *  (3-vector, 3x3 and 6x6 matrix) utilities code driver. These
+ *  types are passed and returned by value, so they live on the
+ *  stack and never touch the heap.
+ *
+ *  @author Miguel Alonso Angulo.
+ *  @bug No known bugs.
+ */
+
+#ifndef _MFIXED_
+#define _MFIXED_
+
+
+/** @brief Vector of 3 components. */
+typedef struct {
+	double v[3];
+} Vec3;
+
+/** @brief Matrix of 3 rows and 3 columns. */
+typedef struct {
+	double m[3][3];
+} Mat3;
+
+/** @brief Matrix of 6 rows and 6 columns. */
+typedef struct {
+	double m[6][6];
+} Mat6;
+
+
+
+/** @brief Copy a vector of 3 components into a Vec3.
+ *
+ *  @param [in] v Vector.
+ *  @return Vec3.
+ */
+Vec3 v3_load(const double *v);
+
+/** @brief Copy a Vec3 into a vector of 3 components.
+ *
+ *  @param [in] a Vec3.
+ *  @param [out] v Vector.
+ */
+void v3_store(Vec3 a, double *v);
+
+/** @brief Sum of two Vec3.
+ *
+ *  @param [in] a First vector.
+ *  @param [in] b Second vector.
+ *  @return Value of sum.
+ */
+Vec3 v3_sum(Vec3 a, Vec3 b);
+
+/** @brief Difference of two Vec3.
+ *
+ *  @param [in] a First vector.
+ *  @param [in] b Second vector.
+ *  @return Value of a-b.
+ */
+Vec3 v3_sub(Vec3 a, Vec3 b);
+
+/** @brief Product of a Vec3 by s scalar.
+ *
+ *  @param [in] a Vector.
+ *  @param [in] s Scalar.
+ *  @return Value of product.
+ */
+Vec3 v3_mul_scalar(Vec3 a, double s);
+
+/** @brief Norm of a Vec3.
+ *
+ *  @param [in] a Vector.
+ *  @return Value of norm.
+ */
+double v3_norm(Vec3 a);
+
+/** @brief Dot product of two Vec3.
+ *
+ *  @param [in] a First vector.
+ *  @param [in] b Second vector.
+ *  @return Value of product.
+ */
+double v3_dot(Vec3 a, Vec3 b);
+
+/** @brief Cross product of two Vec3.
+ *
+ *  @param [in] a First vector.
+ *  @param [in] b Second vector.
+ *  @return Value of product.
+ */
+Vec3 v3_cross(Vec3 a, Vec3 b);
+
+/** @brief Vec3 dot product per Mat3 (a^T*A).
+ *
+ *  @param [in] a Vector.
+ *  @param [in] A Matrix.
+ *  @return Result vector.
+ */
+Vec3 v3_dot_m3(Vec3 a, Mat3 A);
+
+
+
+/** @brief Creation of the 3x3 identity matrix.
+ *
+ *  @return Matrix.
+ */
+Mat3 m3_eye(void);
+
+/** @brief Dot product of two Mat3.
+ *
+ *  @param [in] A First matrix.
+ *  @param [in] B Second matrix.
+ *  @return Result matrix.
+ */
+Mat3 m3_dot(Mat3 A, Mat3 B);
+
+/** @brief Mat3 dot product per Vec3 (A*a).
+ *
+ *  @param [in] A Matrix.
+ *  @param [in] a Vector.
+ *  @return Result vector.
+ */
+Vec3 m3_dot_v3(Mat3 A, Vec3 a);
+
+/** @brief Transposed Mat3 dot product per Vec3 (A^T*a), without
+ *  forming the transpose.
+ *
+ *  @param [in] A Matrix.
+ *  @param [in] a Vector.
+ *  @return Result vector.
+ */
+Vec3 m3_trans_dot_v3(Mat3 A, Vec3 a);
+
+/** @brief Transpose of a Mat3.
+ *
+ *  @param [in] A Matrix.
+ *  @return Result matrix.
+ */
+Mat3 m3_trans(Mat3 A);
+
+
+
+/** @brief Creating a 6x6 matrix of zeros.
+ *
+ *  @return Matrix.
+ */
+Mat6 m6_zeros(void);
+
+/** @brief Creation of the 6x6 identity matrix.
+ *
+ *  @return Matrix.
+ */
+Mat6 m6_eye(void);
+
+/** @brief Dot product of two Mat6.
+ *
+ *  @param [in] A First matrix.
+ *  @param [in] B Second matrix.
+ *  @return Result matrix.
+ */
+Mat6 m6_dot(Mat6 A, Mat6 B);
+
+
+
+#endif
@@ -11,15 +11,19 @@
 #ifndef _MATUTILS_
 #define _MATUTILS_
 
+#include <stddef.h>
 
-/** @brief Creating a vector of c components.
+
+/** @brief Creating a vector of c components, initialised to zero.
+ *  The storage comes from the bound arena, if any (see arena.h).
  *
  *  @param [in] c Number of components.
  *  @return Vector.
  */
 double *v_create(int c);
 
-/** @brief Release a vector of c components.
+/** @brief Release a vector of c components. Vectors owned by the
+ *  bound arena are left to the arena.
  *
  *  @param [in] v Vector.
  *  @param [in] c Number of components.
@@ -132,6 +136,9 @@ double *m_dot_v(double **A, int fA, int cA, double *v, int cv);
 
 
 /** @brief Creating a matrix of f rows and c columns.
+ *  The rows are stored contiguously in row-major order (L[0] is
+ *  the start of the f*c data block). The storage comes from the
+ *  bound arena, if any (see arena.h).
  *
  *  @param [in] f Number of rows.
  *  @param [in] c Number of columns.
@@ -139,7 +146,21 @@ double *m_dot_v(double **A, int fA, int cA, double *v, int cv);
  */
 double **m_create(int f, int c);
 
-/** @brief Release a matrix of f rows and c columns.
+/** @brief Matrix of f rows and c columns over caller-owned storage
+ *  (e.g. arrays on the stack), without allocation.
+ *
+ *  @param [in] data Row-major storage of f*c components.
+ *  @param [out] rows Storage of f row pointers.
+ *  @param [in] f Number of rows.
+ *  @param [in] c Number of columns.
+ *  @return Matrix (rows).
+ */
+double **m_wrap(double *data, double **rows, int f, int c);
+
+/** @brief Release a matrix of f rows and c columns. Matrices owned
+ *  by the bound arena are left to the arena. The matrix must come
+ *  from m_create or a function returning a new matrix; rows
+ *  pointing into other storage (m_wrap) are an error.
  *
  *  @param [in] L Matrix.
  *  @param [in] f Number of rows.
@@ -214,4 +235,142 @@ double **m_trans(double **A, int n);
 
 
 
+/** @brief Scaled vector addition in place (y = y + a*x).
+ *
+ *  @param [in] a Scalar.
+ *  @param [in] x Vector.
+ *  @param [in] cx Number of components in x.
+ *  @param [in,out] y Vector.
+ *  @param [in] cy Number of components in y.
+ */
+void v_axpy(double a, double *x, int cx, double *y, int cy);
+
+/** @brief Vector dot product per matrix into a caller-owned vector.
+ *
+ *  @param [in] v Vector.
+ *  @param [in] cv Number of components in the vector.
+ *  @param [in] A Matrix.
+ *  @param [in] fA Number of rows in the matrix.
+ *  @param [in] cA Number of columns in the matrix.
+ *  @param [out] x Result vector (cA components).
+ */
+void v_dot_m_into(double *v, int cv, double **A, int fA, int cA, double *x);
+
+/** @brief Matrix dot product per vector (column) into a caller-owned vector.
+ *
+ *  @param [in] A Matrix.
+ *  @param [in] fA Number of rows in the matrix.
+ *  @param [in] cA Number of columns in the matrix.
+ *  @param [in] v Vector.
+ *  @param [in] cv Number of components in the vector.
+ *  @param [out] x Result vector (fA components).
+ */
+void m_dot_v_into(double **A, int fA, int cA, double *v, int cv, double *x);
+
+/** @brief Sum of two matrices into a caller-owned matrix
+ *  (L may be A or B).
+ *
+ *  @param [in] A First matrix.
+ *  @param [in] fA Number of rows in the first matrix.
+ *  @param [in] cA Number of columns in the first matrix.
+ *  @param [in] B Second matrix.
+ *  @param [in] fB Number of rows in the second matrix.
+ *  @param [in] cB Number of columns in the second matrix.
+ *  @param [out] L Result matrix (fA x cA).
+ */
+void m_sum_into(double **A, int fA, int cA, double **B, int fB, int cB, double **L);
+
+/** @brief Dot product of two matrices into a caller-owned matrix
+ *  (L must not be A or B).
+ *
+ *  @param [in] A First matrix.
+ *  @param [in] fA Number of rows in the first matrix.
+ *  @param [in] cA Number of columns in the first matrix.
+ *  @param [in] B Second matrix.
+ *  @param [in] fB Number of rows in the second matrix.
+ *  @param [in] cB Number of columns in the second matrix.
+ *  @param [out] L Result matrix (fA x cB).
+ */
+void m_dot_into(double **A, int fA, int cA, double **B, int fB, int cB, double **L);
+
+/** @brief Dot product of a matrix by the transpose of another (A*B^T)
+ *  into a caller-owned matrix, without forming the transpose
+ *  (L must not be A or B).
+ *
+ *  @param [in] A First matrix.
+ *  @param [in] fA Number of rows in the first matrix.
+ *  @param [in] cA Number of columns in the first matrix.
+ *  @param [in] B Second matrix.
+ *  @param [in] fB Number of rows in the second matrix.
+ *  @param [in] cB Number of columns in the second matrix.
+ *  @param [out] L Result matrix (fA x fB).
+ */
+void m_dot_trans_into(double **A, int fA, int cA, double **B, int fB, int cB, double **L);
+
+/** @brief Console printing of the allocation report: allocations,
+ *  frees, live objects and bytes per calling function. Only
+ *  available when built with -DMEM_STATS, in which case it is also
+ *  printed at exit.
+ */
+void mem_report(void);
+
+/** @brief Allocation totals, e.g. to gate changes on. All zero unless
+ *  built with -DMEM_STATS.
+ *
+ *  @param [out] allocs Number of allocations.
+ *  @param [out] live Number of objects not released.
+ *  @param [out] live_bytes Bytes not released.
+ */
+void mem_totals(long *allocs, long *live, size_t *live_bytes);
+
+
+
+/** @brief Allocating utilities recording the allocation against a
+ *  site, the name of the calling function (NULL for unknown). The
+ *  plain functions record no site; with -DMEM_STATS the macros below
+ *  route every call through these with the caller's name.
+ */
+double *v_create_at(const char *site, int c);
+double *v_sum_at(const char *site, double *v, int cv, double *w, int cw);
+double *v_mul_scalar_at(const char *site, double *v, int c, double s);
+double *v_cross_at(const char *site, double *v, int cv, double *w, int cw);
+double **m_create_at(const char *site, int f, int c);
+double *v_extract_at(const char *site, double **A, int fA, int cA, int k);
+double **v_assign_at(const char *site, double *v, int cv, double **A, int fA, int cA, int k);
+double *v_dot_m_at(const char *site, double *v, int cv, double **A, int fA, int cA);
+double *m_dot_v_at(const char *site, double **A, int fA, int cA, double *v, int cv);
+double **m_zeros_at(const char *site, int f, int c);
+double **m_eye_at(const char *site, int n);
+double **m_sum_at(const char *site, double **A, int fA, int cA, double **B, int fB, int cB);
+double **m_dot_at(const char *site, double **A, int fA, int cA, double **B, int fB, int cB);
+double **m_inv_at(const char *site, double **A, int n);
+double **m_trans_at(const char *site, double **A, int n);
+
+
+
+#ifdef MEM_STATS
+
+// Every allocating utility records the name of its caller, passed
+// as an argument so that nested calls stay well defined
+#ifndef M_UTILS_SOURCE
+#define v_create(...)       v_create_at(__func__, __VA_ARGS__)
+#define v_sum(...)          v_sum_at(__func__, __VA_ARGS__)
+#define v_mul_scalar(...)   v_mul_scalar_at(__func__, __VA_ARGS__)
+#define v_cross(...)        v_cross_at(__func__, __VA_ARGS__)
+#define m_create(...)       m_create_at(__func__, __VA_ARGS__)
+#define v_extract(...)      v_extract_at(__func__, __VA_ARGS__)
+#define v_assign(...)       v_assign_at(__func__, __VA_ARGS__)
+#define v_dot_m(...)        v_dot_m_at(__func__, __VA_ARGS__)
+#define m_dot_v(...)        m_dot_v_at(__func__, __VA_ARGS__)
+#define m_zeros(...)        m_zeros_at(__func__, __VA_ARGS__)
+#define m_eye(...)          m_eye_at(__func__, __VA_ARGS__)
+#define m_sum(...)          m_sum_at(__func__, __VA_ARGS__)
+#define m_dot(...)          m_dot_at(__func__, __VA_ARGS__)
+#define m_inv(...)          m_inv_at(__func__, __VA_ARGS__)
+#define m_trans(...)        m_trans_at(__func__, __VA_ARGS__)
+#endif
+
+#endif
+
+
 #endif
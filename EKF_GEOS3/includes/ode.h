@@ -13,11 +13,40 @@
 #define _ODE_
 
 
+/** @brief Integration methods of a context. */
+#define ODE_ADAMS         0   // Variable order Adams PECE of ode (Shampine and Gordon)
+#define ODE_DOP853        1   // Explicit Runge-Kutta 8(5,3) of Dormand and Prince
+#define ODE_GAUSS_JACKSON 2   // Gauss-Jackson of order 8, fixed step, second order equations
+
+/** @brief Bins of the step size histogram: bin i holds the steps with
+ *  2^(i-8) <= |h| < 2^(i-7), the first one also the shorter steps and
+ *  the last one the longer.
+ */
+#define ODE_STATS_BINS 20
+
+/** @brief Highest order of the order histogram. */
+#define ODE_STATS_ORDERS 12
+
+/** @brief Statistics of the integration of a context, accumulated
+ *  over ode_advance, ode_arc and ode_correct until ode_stats_reset.
+ */
+typedef struct {
+	long evals;                       // Evaluations of f
+	long steps;                       // Steps accepted
+	long rejected;                    // Steps rejected
+	long order[ODE_STATS_ORDERS+1];   // Steps accepted per order
+	long step[ODE_STATS_BINS];        // Steps accepted per step size bin
+	double time;                      // Time integrating, f included [s]
+	double f_time;                    // Time in f [s]
+} OdeStats;
+
 /** @brief Interface to an ordinary differential equation solver.
  *
  *  @param [in] f User-supplied function which accepts input
  *  values t and y, evaluates the right hand sides of the ODE,
- *  and stores the result in yp.
+ *  and stores the result in yp. The storage allocated by f is
+ *  released after every evaluation; if an arena is bound (see
+ *  arena.h) it is drawn from and given back to that arena.
  *  @param [in] neqn Number of equations.
  *  @param [in,out] y Current vector solution.
  *  @param [in.out] t Current value of the independent variable.
@@ -33,5 +62,171 @@ void ode ( void f ( double t, double *y, double **yp ), int neqn, double *y,
   double *t, double tout, double relerr, double abserr, int *iflag, 
   double *work, int *iwork );
 
+/** @brief Integrator context for ode. It owns the workspace of the
+ *  Adams method, so its order, its step size and its difference
+ *  history carry over from one output point to the next instead of
+ *  restarting at order 1 with small steps on every call. With
+ *  ODE_DOP853 it holds the state, its derivative and the step size of
+ *  the Runge-Kutta method instead, and all its stages, and with
+ *  ODE_GAUSS_JACKSON the sums and the accelerations of the last nine
+ *  nodes of the fixed step h.
+ */
+typedef struct {
+	void (*f) ( double t, double *y, double **yp );   // Right hand sides
+	int neqn;           // Number of equations
+	int method;         // ODE_ADAMS, ODE_DOP853 or ODE_GAUSS_JACKSON
+	double t;           // Independent variable reached
+	double relerr;      // Relative error tolerance
+	double abserr;      // Absolute error tolerance
+	double h;           // Step of ODE_GAUSS_JACKSON
+	int iflag;          // Status of the last call; 1 before the first step
+	double *work;       // Workspace, 100+47*neqn (ODE_ADAMS), 1+14*neqn (ODE_DOP853),
+	                    // 3+17*neqn/2 (ODE_GAUSS_JACKSON)
+	int iwork[5];       // Workspace
+	OdeStats stats;     // Statistics
+} OdeContext;
+
+/** @brief Steps of an integration, for dense output. Every step
+ *  keeps what intrp needs to evaluate its polynomial: the solution at
+ *  its end, its order and the difference table.
+ */
+typedef struct {
+	int neqn;           // Number of equations
+	int n;              // Steps stored
+	int size;           // Capacity [steps]
+	double *x;          // End of every step
+	int *k;             // Order of every step
+	double *y;          // Solution at the end of every step, neqn each
+	double *phi;        // Differences of every step, 13*neqn each
+	double *psi;        // psi of every step, 12 each
+	double *yp;         // Scratch derivative
+} OdeArc;
+
+/** @brief Creating an integrator context, ODE_ADAMS.
+ *
+ *  @param [in] f Right hand sides, as for ode.
+ *  @param [in] neqn Number of equations.
+ *  @param [in] relerr Relative error tolerance.
+ *  @param [in] abserr Absolute error tolerance.
+ *  @return Context, to be started with ode_start.
+ */
+OdeContext *ode_create ( void f ( double t, double *y, double **yp ), int neqn,
+  double relerr, double abserr );
+
+/** @brief Select the integration method of a context; its workspace
+ *  is allocated here, and the stepping of every method allocates
+ *  nothing. ode_advance, ode_correct and ode_arc dispatch through a
+ *  table in ode.c with the workspace size, the advance, the warm
+ *  restart and the arc of every method, so a new method is a new
+ *  entry there. ODE_DOP853 takes 12 evaluations per step with no
+ *  history, so a correction or a restart costs one evaluation; it
+ *  suits frequent output points and moderate tolerances, ODE_ADAMS
+ *  long arcs at tight tolerances. ODE_GAUSS_JACKSON is for second
+ *  order equations, y = (x, x') with f giving (x', x''), as Accel:
+ *  fixed steps of c->h, usually one evaluation each, with the state
+ *  between the steps interpolated, for long arcs; the tolerances
+ *  only end its corrector and starting iterations. The context has
+ *  to be started again with ode_start.
+ *
+ *  @param [in] c Context.
+ *  @param [in] method ODE_ADAMS, ODE_DOP853 or ODE_GAUSS_JACKSON.
+ *  @return Previous method.
+ */
+int ode_method ( OdeContext *c, int method );
+
+/** @brief Release an integrator context.
+ *
+ *  @param [in] c Context.
+ */
+void ode_free ( OdeContext *c );
+
+/** @brief Cold start: the next ode_advance starts at t from the state
+ *  it is given, at order 1.
+ *
+ *  @param [in] c Context.
+ *  @param [in] t Initial value of the independent variable.
+ */
+void ode_start ( OdeContext *c, double t );
+
+/** @brief Integrate to tout, stopping there exactly, and keep the
+ *  order, step size and history for the next call. Runs of more than
+ *  500 steps are continued.
+ *
+ *  @param [in] c Context.
+ *  @param [in,out] y State: at c->t on the first call after
+ *  ode_start, and only output on later calls (see ode_correct).
+ *  @param [in] tout Desired value of the independent variable.
+ *  @return Status as the iflag of ode; 2 on success.
+ */
+int ode_advance ( OdeContext *c, double *y, double tout );
+
+/** @brief Integrate to tout with the natural step sizes, recording
+ *  every step for ode_arc_eval; the last step is shortened to end at
+ *  tout. The steps are added to the arc, which is emptied on a cold
+ *  start or a change of direction. ODE_ADAMS contexts only.
+ *
+ *  @param [in] c Context.
+ *  @param [in,out] y State, as for ode_advance.
+ *  @param [in] tout End of the arc.
+ *  @param [in,out] a Arc.
+ *  @return Status: 2 on success, 3 if the tolerances were too small
+ *  and were increased, as ode does; then c->relerr and c->abserr
+ *  hold the increased ones.
+ */
+int ode_arc ( OdeContext *c, double *y, double tout, OdeArc *a );
+
+/** @brief Creating an empty arc.
+ *
+ *  @param [in] neqn Number of equations.
+ *  @return Arc.
+ */
+OdeArc *ode_arc_create ( int neqn );
+
+/** @brief Release an arc.
+ *
+ *  @param [in] a Arc.
+ */
+void ode_arc_free ( OdeArc *a );
+
+/** @brief Solution anywhere within an arc, from the polynomial of the
+ *  step that covers t, as accurate as the integration itself. Outside
+ *  the arc the nearest step is extrapolated. An arc with no steps is
+ *  an error.
+ *
+ *  @param [in] a Arc, with at least one step.
+ *  @param [in] t Value of the independent variable.
+ *  @param [out] y Solution at t.
+ *  @param [out] yp Derivative at t, or NULL.
+ */
+void ode_arc_eval ( OdeArc *a, double t, double *y, double *yp );
+
+/** @brief Warm restart: replace the state at c->t, as after a
+ *  measurement update, keeping the order and the step size. With
+ *  ODE_ADAMS the history is rebuilt on the solution through the new
+ *  state: the derivatives at the past nodes are evaluated again on
+ *  it, found by a fixed point iteration, a few evaluations per node.
+ *  ODE_DOP853 has no history, so only the derivative at the new state
+ *  is evaluated, and ODE_GAUSS_JACKSON is started again at c->t; if
+ *  that start does not converge, c->iflag is 6 and the context is
+ *  left as it was before the call.
+ *
+ *  @param [in] c Context.
+ *  @param [in] y New state at c->t.
+ */
+void ode_correct ( OdeContext *c, const double *y );
+
+/** @brief Clear the statistics of a context.
+ *
+ *  @param [in] c Context.
+ */
+void ode_stats_reset ( OdeContext *c );
+
+/** @brief Console printing of the statistics of a context: totals,
+ *  steps per order and steps per step size bin.
+ *
+ *  @param [in] s Statistics, c->stats.
+ */
+void ode_stats_print ( const OdeStats *s );
+
 
 #endif
@@ -15,68 +15,101 @@
 #include "../includes/const.h"
 #include "../includes/IERS.h"
 #include "../includes/timediff.h"
-#include "../includes/PrecMatrix.h"
-#include "../includes/NutMatrix.h"
 #include "../includes/m_utils.h"
+#include "../includes/m_fixed.h"
 #include "../includes/PoleMatrix.h"
-#include "../includes/GHAMatrix.h"
+#include "../includes/EarthRot.h"
 #include "../includes/Mjday_TDB.h"
 #include "../includes/JPL_Eph_DE430.h"
 #include "../includes/AccelHarmonic.h"
+#include "../includes/Cunningham.h"
+#include "../includes/GravGrid.h"
 #include "../includes/AccelPointMass.h"
 
 #include <stdio.h>
 #include <math.h>
 
 
-void Accel(double x, double *Y, double **dY) {
+Vec3 Accel_gradient(double x, Vec3 r, Mat3 *G) {
 	extern Param AuxParam;
 
-	double x_pole, y_pole, UT1_UTC, LOD, dpsi, deps, dx_pole, dy_pole, TAI_UTC;
-	IERS(AuxParam.Mjd_UTC + x/86400.0,'l',&x_pole,&y_pole,&UT1_UTC,&LOD,&dpsi,&deps,&dx_pole,&dy_pole,&TAI_UTC);
+	EOP eop;
+	IERS_eop(AuxParam.Mjd_UTC + x/86400.0,'l',&eop);
 	
 	double UT1_TAI, UTC_GPS, UT1_GPS, TT_UTC, GPS_UTC;
-	timediff(UT1_UTC,TAI_UTC,&UT1_TAI,&UTC_GPS,&UT1_GPS,&TT_UTC,&GPS_UTC);
+	timediff(eop.UT1_UTC,eop.TAI_UTC,&UT1_TAI,&UTC_GPS,&UT1_GPS,&TT_UTC,&GPS_UTC);
 	
-	double Mjd_UT1 = AuxParam.Mjd_UTC + x/86400.0 + UT1_UTC/86400.0;
+	double Mjd_UT1 = AuxParam.Mjd_UTC + x/86400.0 + eop.UT1_UTC/86400.0;
 	double Mjd_TT = AuxParam.Mjd_UTC + x/86400.0 + TT_UTC/86400.0;
 	
-	double **P = PrecMatrix((MJD_J2000),Mjd_TT);
-	double **N = NutMatrix(Mjd_TT);
-	double **T = m_dot(N,3,3,P,3,3);
-	double **E = m_dot(m_dot(PoleMatrix(x_pole,y_pole),3,3,GHAMatrix(Mjd_UT1),3,3),3,3,T,3,3);
+	EarthRot *er = EarthRot_current();
+	Mat3 T = EarthRot_NP(er,Mjd_TT);
+	Mat3 E = m3_dot(m3_dot(PoleMatrix(eop.x_pole,eop.y_pole),EarthRot_GHA(er,Mjd_UT1)),T);
 
-	double Mjday = Mjday_TDB(Mjd_TT);
-	double *r_Mercury, *r_Venus, *r_Earth, *r_Mars, *r_Jupiter, *r_Saturn, *r_Uranus, *r_Neptune, *r_Pluto, *r_Moon, *r_Sun;
-	JPL_Eph_DE430(Mjday,&r_Mercury,&r_Venus,&r_Earth,&r_Mars,&r_Jupiter,&r_Saturn,&r_Uranus,&r_Neptune,&r_Pluto,&r_Moon,&r_Sun);
+	// Only the bodies of the force model
+	int mask = 0;
+	if(AuxParam.sun) {
+		mask |= JPL_MASK(JPL_SUN);
+	}
+	if(AuxParam.moon) {
+		mask |= JPL_MASK(JPL_MOON);
+	}
+	if(AuxParam.planets) {
+		mask |= JPL_PLANETS;
+	}
 	
-	// Acceleration due to harmonic gravity field
-	double *Y_aux = v_create(3);
-	Y_aux[0] = Y[0]; Y_aux[1] = Y[1]; Y_aux[2] = Y[2];
-	double *a = AccelHarmonic(Y_aux, E, AuxParam.n, AuxParam.m);
+	Vec3 rb[JPL_BODIES];
+	if(mask) {
+		JPL_Eph_DE430_bodies(Mjday_TDB(Mjd_TT), mask, rb);
+	}
+	
+	// Acceleration due to harmonic gravity field; with its gradient,
+	// both from one Cunningham recursion of the full degree and order
+	// (counted with the evaluations of AccelHarmonic), otherwise from the bound grid or with the degree for the current
+	// radius when adaptive
+	GravGrid *gg = GravGrid_current();
+	int n = AuxParam.n, m = AuxParam.m;
+	Vec3 a;
+	if(G != NULL) {
+		a = Cunningham(r, E, n, m, G);
+		AccelHarmonic_count(n, 1);
+	}
+	else {
+		if(AuxParam.tol > 0.0) {
+			n = AccelHarmonic_degree(v3_norm(r), AuxParam.n, AuxParam.tol);
+			m = (m < n) ? m : n;
+		}
+		a = (gg != NULL) ? GravGrid_accel(gg, r, E) : AccelHarmonic(r, E, n, m);
+	}
 
 	// Luni-solar perturbations
 	if(AuxParam.sun) {
-		a = v_sum(a,3,AccelPointMass(Y_aux,r_Sun,(GM_Sun)),3);
+		a = v3_sum(a,AccelPointMass(r,rb[JPL_SUN],(GM_Sun)));
 	}
 
 	if(AuxParam.moon) {
-		a = v_sum(a,3,AccelPointMass(Y_aux,r_Moon,(GM_Moon)),3);
+		a = v3_sum(a,AccelPointMass(r,rb[JPL_MOON],(GM_Moon)));
 	}
 
 	// Planetary perturbations
 	if(AuxParam.planets) {
-		a = v_sum(a,3,AccelPointMass(Y_aux,r_Mercury,(GM_Mercury)),3);
-		a = v_sum(a,3,AccelPointMass(Y_aux,r_Venus,(GM_Venus)),3);
-		a = v_sum(a,3,AccelPointMass(Y_aux,r_Mars,(GM_Mars)),3);
-		a = v_sum(a,3,AccelPointMass(Y_aux,r_Jupiter,(GM_Jupiter)),3);
-		a = v_sum(a,3,AccelPointMass(Y_aux,r_Saturn,(GM_Saturn)),3);
-		a = v_sum(a,3,AccelPointMass(Y_aux,r_Uranus,(GM_Uranus)),3);
-		a = v_sum(a,3,AccelPointMass(Y_aux,r_Neptune,(GM_Neptune)),3);
-		a = v_sum(a,3,AccelPointMass(Y_aux,r_Pluto,(GM_Pluto)),3);
+		a = v3_sum(a,AccelPointMass(r,rb[JPL_MERCURY],(GM_Mercury)));
+		a = v3_sum(a,AccelPointMass(r,rb[JPL_VENUS],(GM_Venus)));
+		a = v3_sum(a,AccelPointMass(r,rb[JPL_MARS],(GM_Mars)));
+		a = v3_sum(a,AccelPointMass(r,rb[JPL_JUPITER],(GM_Jupiter)));
+		a = v3_sum(a,AccelPointMass(r,rb[JPL_SATURN],(GM_Saturn)));
+		a = v3_sum(a,AccelPointMass(r,rb[JPL_URANUS],(GM_Uranus)));
+		a = v3_sum(a,AccelPointMass(r,rb[JPL_NEPTUNE],(GM_Neptune)));
+		a = v3_sum(a,AccelPointMass(r,rb[JPL_PLUTO],(GM_Pluto)));
 	}
 
+	return a;
+}
+
+void Accel(double x, double *Y, double **dY) {
+	Vec3 a = Accel_gradient(x, v3_load(Y), NULL);
+
 	*dY = v_create(6);
-	(*dY)[0] = Y[3]; (*dY)[1] = Y[4]; (*dY)[2] = Y[5]; (*dY)[3] = a[0]; (*dY)[4] = a[1]; (*dY)[5] = a[2];
+	(*dY)[0] = Y[3]; (*dY)[1] = Y[4]; (*dY)[2] = Y[5]; (*dY)[3] = a.v[0]; (*dY)[4] = a.v[1]; (*dY)[5] = a.v[2];
 }
 
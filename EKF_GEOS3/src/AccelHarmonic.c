@@ -10,61 +10,376 @@
  *  @bug No know bugs.
  */
 
+#include "../includes/AccelHarmonic.h"
 #include "../includes/global.h"
 #include "../includes/Legendre.h"
+#include "../includes/Cunningham.h"
+#include "../includes/GravModel.h"
 #include "../includes/m_utils.h"
+#include "../includes/m_fixed.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 
 
-double *AccelHarmonic(double *r, double **E, int n_max, int m_max) {
-	extern double **Cnm, **Snm;
+static int engine = HARMONIC_LEGENDRE;
+static LegendreEngine *leg = NULL;   // Engine of the highest n_max, m_max so far
+static const GravModel *src = NULL;  // Model the coefficients are read from
+static double *cm = NULL, *sm = NULL; // cos(m*lon) and sin(m*lon)
+static double *bp = NULL, *bdp = NULL;   // Lanes of pnm and dpnm of a batch block
+static double *bcm = NULL, *bsm = NULL;  // Lanes of cos(m*lon) and sin(m*lon)
+static double *sig = NULL;           // sqrt(sum_m(Cnm^2+Snm^2)) per degree
+static long sig_gen = -1;            // Generation of the model sig was computed from
+static int sig_n = -1;               // Highest degree of sig
+static long uses[HARMONIC_MAX_DEGREE+1];   // Evaluations per degree
+
+// Engine and tables for at least n_max, m_max. They are only
+// reallocated for a degree or an order above every one before, so
+// that the lower degrees of the adaptive field evaluate the recursion
+// truncated in them. The coefficients are read from the bound model
+// in place.
+static void setup(int n_max, int m_max) {
+	const GravModel *g = GravModel_current();
 	
-	double r_ref = 6378.1363e3;   // Earth's radius [m]; GGM03S
-	double gm    = 398600.4415e9; // [m^3/s^2]; GGM03S
+	if(g == NULL || n_max > g->n) {
+		printf("AccelHarmonic: error\n");
+		exit(EXIT_FAILURE);
+	}
+	src = g;
+	if(leg != NULL && n_max <= leg->n && m_max <= leg->m) {
+		return;
+	}
+	
+	if(leg != NULL) {
+		n_max = (n_max > leg->n) ? n_max : leg->n;
+		m_max = (m_max > leg->m) ? m_max : leg->m;
+		Legendre_free(leg);
+		free(cm);
+		free(sm);
+		free(bp);
+		free(bdp);
+		free(bcm);
+		free(bsm);
+	}
+	
+	int size = LEG_NM(n_max,n_max)+1;
+	leg = Legendre_create(n_max,m_max);
+	cm = (double *) calloc(m_max+2, sizeof(double));
+	sm = (double *) calloc(m_max+2, sizeof(double));
+	bp = (double *) calloc(HARMONIC_LANES*size, sizeof(double));
+	bdp = (double *) calloc(HARMONIC_LANES*size, sizeof(double));
+	bcm = (double *) calloc(HARMONIC_LANES*(m_max+2), sizeof(double));
+	bsm = (double *) calloc(HARMONIC_LANES*(m_max+2), sizeof(double));
+	if(cm == NULL || sm == NULL ||
+	   bp == NULL || bdp == NULL || bcm == NULL || bsm == NULL) {
+		printf("AccelHarmonic: error\n");
+		exit(EXIT_FAILURE);
+	}
+}
+
+Vec3 AccelHarmonic(Vec3 r, Mat3 E, int n_max, int m_max) {
+	if(n_max >= 0 && n_max <= HARMONIC_MAX_DEGREE) {
+		uses[n_max]++;
+	}
+	if(engine == HARMONIC_CUNNINGHAM) {
+		return Cunningham(r, E, n_max, m_max, NULL);
+	}
 	
 	// Body-fixed position 
-	double *r_bf = m_dot_v(E,3,3,r,3);
+	Vec3 r_bf = m3_dot_v3(E,r);
 
 	// Auxiliary quantities
-	double d = v_norm(r_bf,3);                     // distance
-	double latgc = asin(r_bf[2]/d);
-	double lon = atan2(r_bf[1],r_bf[0]);
+	double d = v3_norm(r_bf);                      // distance
+	double latgc = asin(r_bf.v[2]/d);
+	double lon = atan2(r_bf.v[1],r_bf.v[0]);
 	
-	double **pnm, **dpnm;
-	Legendre(n_max,m_max,latgc,&pnm,&dpnm);
+	setup(n_max,m_max);
+	Legendre_eval_nm(leg,latgc,n_max,m_max);
+	double *pnm = leg->pnm, *dpnm = leg->dpnm;
+	const double *cs = src->cs;   // Cnm, Snm interleaved
+	double r_ref = src->r_ref;
+	double gm    = src->gm;
+	
+	// cos(m*lon) and sin(m*lon) by the angle-addition recurrence
+	double cl = cos(lon);
+	cm[0] = 1.0; sm[0] = 0.0;
+	cm[1] = cl;  sm[1] = sin(lon);
+	for(int m=2; m<=m_max; m++) {
+		cm[m] = 2.0*cl*cm[m-1]-cm[m-2];
+		sm[m] = 2.0*cl*sm[m-1]-sm[m-2];
+	}
 	
 	double dUdr = 0;
 	double dUdlatgc = 0;
 	double dUdlon = 0;
-	double q3 = 0, q2 = q3, q1 = q2;
+	double q1, q2, q3;
 	double b1,b2,b3;
+	double rr = r_ref/d, rn = 1.0;   // (r_ref/d)^n
 	for(int n=0; n<=n_max; n++) {
-		b1 = (-gm/(d*d))*pow((r_ref/d),n)*(n+1);
-		b2 =  (gm/d)*pow((r_ref/d),n);
-		b3 =  (gm/d)*pow((r_ref/d),n);
-		for(int m=0; m<=m_max; m++) {
-			q1 = q1 + pnm[n][m]*(Cnm[n][m]*cos(m*lon)+Snm[n][m]*sin(m*lon));
-			q2 = q2 + dpnm[n][m]*(Cnm[n][m]*cos(m*lon)+Snm[n][m]*sin(m*lon));
-			q3 = q3 + m*pnm[n][m]*(Snm[n][m]*cos(m*lon)-Cnm[n][m]*sin(m*lon));
+		b1 = (-gm/(d*d))*rn*(n+1);
+		b2 =  (gm/d)*rn;
+		b3 =  b2;
+		
+		int k = LEG_NM(n,0);
+		int mm = (m_max < n) ? m_max : n;
+		q1 = 0; q2 = 0; q3 = 0;
+		for(int m=0; m<=mm; m++) {
+			double c = cs[2*(k+m)], s = cs[2*(k+m)+1];
+			double u = c*cm[m]+s*sm[m];
+			
+			q1 = q1 + pnm[k+m]*u;
+			q2 = q2 + dpnm[k+m]*u;
+			q3 = q3 + m*pnm[k+m]*(s*cm[m]-c*sm[m]);
 		}
 		dUdr     = dUdr     + q1*b1;
 		dUdlatgc = dUdlatgc + q2*b2;
 		dUdlon   = dUdlon   + q3*b3;
-		q3 = 0; q2 = q3; q1 = q2;
+		rn = rn*rr;
 	}
 	
 	// Body-fixed acceleration
-	double r2xy = r_bf[0]*r_bf[0]+r_bf[1]*r_bf[1];
+	double r2xy = r_bf.v[0]*r_bf.v[0]+r_bf.v[1]*r_bf.v[1];
 
-	double ax = (1/d*dUdr-r_bf[2]/(d*d*sqrt(r2xy))*dUdlatgc)*r_bf[0]-(1/r2xy*dUdlon)*r_bf[1];
-	double ay = (1/d*dUdr-r_bf[2]/(d*d*sqrt(r2xy))*dUdlatgc)*r_bf[1]+(1/r2xy*dUdlon)*r_bf[0];
-	double az =  1/d*dUdr*r_bf[2]+sqrt(r2xy)/(d*d)*dUdlatgc;
+	double ax = (1/d*dUdr-r_bf.v[2]/(d*d*sqrt(r2xy))*dUdlatgc)*r_bf.v[0]-(1/r2xy*dUdlon)*r_bf.v[1];
+	double ay = (1/d*dUdr-r_bf.v[2]/(d*d*sqrt(r2xy))*dUdlatgc)*r_bf.v[1]+(1/r2xy*dUdlon)*r_bf.v[0];
+	double az =  1/d*dUdr*r_bf.v[2]+sqrt(r2xy)/(d*d)*dUdlatgc;
 
-	double *a_bf = v_create(3);
-	a_bf[0] = ax; a_bf[1] = ay; a_bf[2] = az;
+	Vec3 a_bf = {{ax, ay, az}};
 
 	// Inertial acceleration
-	return m_dot_v(m_trans(E,3),3,3,a_bf,3);
+	return m3_trans_dot_v3(E,a_bf);
+}
+
+int AccelHarmonic_engine(int e) {
+	int old = engine;
+	
+	if(e != HARMONIC_LEGENDRE && e != HARMONIC_CUNNINGHAM) {
+		printf("AccelHarmonic: error\n");
+		exit(EXIT_FAILURE);
+	}
+	engine = e;
+	
+	return old;
+}
+
+// Legendre_eval_nm on the lanes of a block, from the cosine and sine
+// of the latitudes; lane l of (n,m) is at HARMONIC_LANES*LEG_NM(n,m)+l
+static void legendre_lanes(const double *cf, const double *sf, int n, int m) {
+	m = (m < n) ? m : n;
+	double *p = bp, *dp = bdp;
+	
+	for(int l=0; l<HARMONIC_LANES; l++) {
+		p[l] = 1;
+		dp[l] = 0;
+	}
+	if(n < 1) {
+		return;
+	}
+	for(int l=0; l<HARMONIC_LANES; l++) {
+		p[HARMONIC_LANES*LEG_NM(1,1)+l] = leg->diag[1]*cf[l];
+		dp[HARMONIC_LANES*LEG_NM(1,1)+l] = -leg->diag[1]*sf[l];
+	}
+	
+	// diagonal coefficients
+	for(int i=2; i<=m; i++) {
+		double *p0 = &p[HARMONIC_LANES*LEG_NM(i,i)], *p1 = &p[HARMONIC_LANES*LEG_NM(i-1,i-1)];
+		double *d0 = &dp[HARMONIC_LANES*LEG_NM(i,i)], *d1 = &dp[HARMONIC_LANES*LEG_NM(i-1,i-1)];
+		
+		for(int l=0; l<HARMONIC_LANES; l++) {
+			p0[l] = leg->diag[i]*cf[l]*p1[l];
+			d0[l] = leg->diag[i]*((cf[l]*d1[l])-(sf[l]*p1[l]));
+		}
+	}
+	
+	// horizontal first step coefficients
+	for(int i=1; i<=n && i<=m+1; i++) {
+		double *p0 = &p[HARMONIC_LANES*LEG_NM(i,i-1)], *p1 = &p[HARMONIC_LANES*LEG_NM(i-1,i-1)];
+		double *d0 = &dp[HARMONIC_LANES*LEG_NM(i,i-1)], *d1 = &dp[HARMONIC_LANES*LEG_NM(i-1,i-1)];
+		
+		for(int l=0; l<HARMONIC_LANES; l++) {
+			p0[l] = leg->sub[i]*sf[l]*p1[l];
+			d0[l] = leg->sub[i]*((cf[l]*p1[l])+(sf[l]*d1[l]));
+		}
+	}
+	
+	// horizontal second step coefficients
+	for(int j=0; j<=m; j++) {
+		for(int i=j+2; i<=n; i++) {
+			int k = LEG_NM(i,j);
+			double a = leg->a[k], b = leg->b[i], c = leg->c[k];
+			double *p0 = &p[HARMONIC_LANES*k], *d0 = &dp[HARMONIC_LANES*k];
+			double *p1 = &p[HARMONIC_LANES*LEG_NM(i-1,j)], *d1 = &dp[HARMONIC_LANES*LEG_NM(i-1,j)];
+			double *p2 = &p[HARMONIC_LANES*LEG_NM(i-2,j)], *d2 = &dp[HARMONIC_LANES*LEG_NM(i-2,j)];
+			
+			for(int l=0; l<HARMONIC_LANES; l++) {
+				double bs = b*sf[l];
+				
+				p0[l] = a*((bs*p1[l])-(c*p2[l]));
+				d0[l] = a*((bs*d1[l])+(b*cf[l]*p1[l])-(c*d2[l]));
+			}
+		}
+	}
+}
+
+void AccelHarmonic_batch(int N, const double *x, const double *y, const double *z,
+						 int n_max, int m_max, double *ax, double *ay, double *az) {
+	const int L = HARMONIC_LANES;
+	
+	setup(n_max,m_max);
+	const double *cs = src->cs;   // Cnm, Snm interleaved
+	double r_ref = src->r_ref;
+	double gm    = src->gm;
+	if(n_max >= 0 && n_max <= HARMONIC_MAX_DEGREE) {
+		uses[n_max] += N;
+	}
+	
+	for(int i0=0; i0<N; i0+=L) {
+		double d[HARMONIC_LANES], cf[HARMONIC_LANES], sf[HARMONIC_LANES];
+		double cl[HARMONIC_LANES], rr[HARMONIC_LANES], rn[HARMONIC_LANES];
+		double dUdr[HARMONIC_LANES], dUdlatgc[HARMONIC_LANES], dUdlon[HARMONIC_LANES];
+		
+		// Auxiliary quantities; lanes past the end repeat the first
+		// satellite of the block
+		for(int l=0; l<L; l++) {
+			int i = (i0+l < N) ? i0+l : i0;
+			
+			d[l] = sqrt(x[i]*x[i]+y[i]*y[i]+z[i]*z[i]);
+			double latgc = asin(z[i]/d[l]);
+			double lon = atan2(y[i],x[i]);
+			
+			cf[l] = cos(latgc);
+			sf[l] = sin(latgc);
+			cl[l] = cos(lon);
+			bcm[l] = 1.0;      bsm[l] = 0.0;
+			bcm[L+l] = cl[l];  bsm[L+l] = sin(lon);
+			rr[l] = r_ref/d[l];
+			rn[l] = 1.0;
+			dUdr[l] = dUdlatgc[l] = dUdlon[l] = 0.0;
+		}
+		
+		legendre_lanes(cf,sf,n_max,m_max);
+		
+		// cos(m*lon) and sin(m*lon) by the angle-addition recurrence
+		for(int m=2; m<=m_max; m++) {
+			for(int l=0; l<L; l++) {
+				bcm[L*m+l] = 2.0*cl[l]*bcm[L*(m-1)+l]-bcm[L*(m-2)+l];
+				bsm[L*m+l] = 2.0*cl[l]*bsm[L*(m-1)+l]-bsm[L*(m-2)+l];
+			}
+		}
+		
+		// Harmonic sums, every coefficient shared by the lanes
+		for(int n=0; n<=n_max; n++) {
+			double q1[HARMONIC_LANES] = {0}, q2[HARMONIC_LANES] = {0}, q3[HARMONIC_LANES] = {0};
+			int k = LEG_NM(n,0);
+			int mm = (m_max < n) ? m_max : n;
+			
+			for(int m=0; m<=mm; m++) {
+				double c = cs[2*(k+m)], s = cs[2*(k+m)+1];
+				const double *p = &bp[L*(k+m)], *dp = &bdp[L*(k+m)];
+				const double *cmm = &bcm[L*m], *smm = &bsm[L*m];
+				
+				for(int l=0; l<L; l++) {
+					double cs = c*cmm[l]+s*smm[l];
+					
+					q1[l] = q1[l] + p[l]*cs;
+					q2[l] = q2[l] + dp[l]*cs;
+					q3[l] = q3[l] + m*p[l]*(s*cmm[l]-c*smm[l]);
+				}
+			}
+			for(int l=0; l<L; l++) {
+				double b2 = (gm/d[l])*rn[l];
+				
+				dUdr[l]     = dUdr[l]     + q1[l]*((-gm/(d[l]*d[l]))*rn[l]*(n+1));
+				dUdlatgc[l] = dUdlatgc[l] + q2[l]*b2;
+				dUdlon[l]   = dUdlon[l]   + q3[l]*b2;
+				rn[l] = rn[l]*rr[l];
+			}
+		}
+		
+		// Body-fixed acceleration
+		for(int l=0; l<L && i0+l<N; l++) {
+			int i = i0+l;
+			double r2xy = x[i]*x[i]+y[i]*y[i];
+			
+			ax[i] = (1/d[l]*dUdr[l]-z[i]/(d[l]*d[l]*sqrt(r2xy))*dUdlatgc[l])*x[i]-(1/r2xy*dUdlon[l])*y[i];
+			ay[i] = (1/d[l]*dUdr[l]-z[i]/(d[l]*d[l]*sqrt(r2xy))*dUdlatgc[l])*y[i]+(1/r2xy*dUdlon[l])*x[i];
+			az[i] =  1/d[l]*dUdr[l]*z[i]+sqrt(r2xy)/(d[l]*d[l])*dUdlatgc[l];
+		}
+	}
+}
+
+int AccelHarmonic_degree(double d, int n_max, double tol) {
+	const GravModel *g = GravModel_current();
+	
+	if(g == NULL || n_max > g->n) {
+		printf("AccelHarmonic: error\n");
+		exit(EXIT_FAILURE);
+	}
+	double r_ref = g->r_ref;
+	double gm    = g->gm;
+	
+	// Degree amplitudes, over all the orders
+	if(sig_n < n_max || sig_gen != GravModel_generation()) {
+		free(sig);
+		sig = (double *) calloc(n_max+1, sizeof(double));
+		if(sig == NULL) {
+			printf("AccelHarmonic: error\n");
+			exit(EXIT_FAILURE);
+		}
+		for(int n=0; n<=n_max; n++) {
+			for(int m=0; m<=n; m++) {
+				sig[n] = sig[n] + GRAV_C(g,n,m)*GRAV_C(g,n,m) + GRAV_S(g,n,m)*GRAV_S(g,n,m);
+			}
+			sig[n] = sqrt(sig[n]);
+		}
+		sig_n = n_max;
+		sig_gen = GravModel_generation();
+	}
+	
+	// Bound of the omitted acceleration, from the top degree down
+	double rr = r_ref/d, rn = pow(rr,n_max), omitted = 0.0;
+	int n = n_max;
+	
+	while(n > 0) {
+		double an = gm/(d*d)*(2*n+1)*sqrt(n+1.0)*rn*sig[n];
+		
+		if(omitted + an > tol) {
+			break;
+		}
+		omitted = omitted + an;
+		rn = rn/rr;
+		n--;
+	}
+	
+	return n;
+}
+
+long AccelHarmonic_uses(int n) {
+	if(n < 0 || n > HARMONIC_MAX_DEGREE) {
+		return 0;
+	}
+	
+	return uses[n];
+}
+
+void AccelHarmonic_count(int n, long k) {
+	if(n >= 0 && n <= HARMONIC_MAX_DEGREE) {
+		uses[n] += k;
+	}
+}
+
+void AccelHarmonic_report(void) {
+	long total = 0;
+	
+	for(int n=0; n<=HARMONIC_MAX_DEGREE; n++) {
+		total += uses[n];
+	}
+	
+	printf("\nGravity degree	%10s	%8s\n", "evals", "share");
+	for(int n=0; n<=HARMONIC_MAX_DEGREE; n++) {
+		if(uses[n] > 0) {
+			printf("%d	%10ld	%7.2lf%%\n", n, uses[n], 100.0*uses[n]/total);
+		}
+	}
 }
@@ -8,18 +8,18 @@
  *  @bug No know bugs.
  */
 
-#include "../includes/m_utils.h"
+#include "../includes/m_fixed.h"
 
 #include <stdio.h>
 #include <math.h>
 
 
-double *AccelPointMass(double *r, double *s, double GM) {
+Vec3 AccelPointMass(Vec3 r, Vec3 s, double GM) {
 	// Relative position vector of satellite w.r.t. point mass 
-	double *d = v_sum(r,3,v_mul_scalar(s,3,-1),3);
+	Vec3 d = v3_sub(r,s);
 
 	// Acceleration 
-	double *d_aux = v_mul_scalar(d,3,-GM/(pow(v_norm(d,3),3.0)));
-	double *v_aux = v_mul_scalar(s,3,-GM/(pow(v_norm(s,3),3.0)));
-	return v_sum(d_aux,3,v_aux,3);
+	Vec3 d_aux = v3_mul_scalar(d,-GM/(pow(v3_norm(d),3.0)));
+	Vec3 v_aux = v3_mul_scalar(s,-GM/(pow(v3_norm(s),3.0)));
+	return v3_sum(d_aux,v_aux);
 }
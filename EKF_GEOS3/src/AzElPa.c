@@ -16,7 +16,7 @@
 #include <math.h>
 
 
-void AzElPa(double *s, double *Az, double *El, double **dAds, double **dEds) {
+void AzElPa(double *s, double *Az, double *El, double *dAds, double *dEds) {
 	double rho = sqrt(s[0]*s[0]+s[1]*s[1]);
 	
 	// Angles
@@ -29,13 +29,11 @@ void AzElPa(double *s, double *Az, double *El, double **dAds, double **dEds) {
 	*El = atan(s[2]/rho);
 	
 	// Partials
-	*dAds = v_create(3);
-	(*dAds)[0] = s[1]/(rho*rho);
-	(*dAds)[1] = -s[0]/(rho*rho);
-	(*dAds)[2] = 0.0;
+	dAds[0] = s[1]/(rho*rho);
+	dAds[1] = -s[0]/(rho*rho);
+	dAds[2] = 0.0;
 	
-	*dEds = v_create(3);
-	(*dEds)[0] = (-s[0]*s[2]/rho)/v_dot(s,3,s,3);
-	(*dEds)[1] = (-s[1]*s[2]/rho)/v_dot(s,3,s,3);
-	(*dEds)[2] = (rho)/v_dot(s,3,s,3);
+	dEds[0] = (-s[0]*s[2]/rho)/v_dot(s,3,s,3);
+	dEds[1] = (-s[1]*s[2]/rho)/v_dot(s,3,s,3);
+	dEds[2] = (rho)/v_dot(s,3,s,3);
 }
@@ -8,13 +8,169 @@
  *  @bug No know bugs.
  */
 
+#include "../includes/Cheb3D.h"
 #include "../includes/m_utils.h"
+#include "../includes/m_fixed.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+
+// Clenshaw recursion of one block of CHEB_LANES series. Lanes past
+// the end of a shorter series see zero coefficients, which leave
+// f1 = f2 = 0 until its own highest coefficient is reached, so the
+// result is the same as evaluating each series on its own. Every
+// lane is held in its own variable, so that the recursion stays in
+// registers; with AVX2 the four lanes share one register. Below the
+// shortest series every lane reads its coefficient directly.
+static void lanes(const int *N, const double *tau, double *const *C, double *f1, double *f2) {
+	const double *C0 = C[0], *C1 = C[1], *C2 = C[2], *C3 = C[3];
+	int N0 = N[0], N1 = N[1], N2 = N[2], N3 = N[3];
+	int Nmax = N0, Nmin = N0;
+	double c0, c1, c2, c3;
+	
+	for(int l = 1; l < CHEB_LANES; l++) {
+		if(N[l] > Nmax)
+			Nmax = N[l];
+		if(N[l] < Nmin)
+			Nmin = N[l];
+	}
+	
+#ifdef __AVX2__
+	__m256d t = _mm256_set_pd(2.0*tau[3], 2.0*tau[2], 2.0*tau[1], 2.0*tau[0]);
+	__m256d b1 = _mm256_setzero_pd(), b2 = _mm256_setzero_pd(), tmp;
+	
+	for(int i = Nmax-1; i>0; i--) {
+		if(i < Nmin) {
+			c0 = C0[i]; c1 = C1[i]; c2 = C2[i]; c3 = C3[i];
+		} else {
+			c0 = (i < N0) ? C0[i] : 0.0;
+			c1 = (i < N1) ? C1[i] : 0.0;
+			c2 = (i < N2) ? C2[i] : 0.0;
+			c3 = (i < N3) ? C3[i] : 0.0;
+		}
+		
+		tmp = _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(t, b1), b2), _mm256_set_pd(c3, c2, c1, c0));
+		b2 = b1;
+		b1 = tmp;
+	}
+	
+	_mm256_storeu_pd(f1, b1);
+	_mm256_storeu_pd(f2, b2);
+#else
+	double t0 = 2.0*tau[0], t1 = 2.0*tau[1], t2 = 2.0*tau[2], t3 = 2.0*tau[3];
+	double a0 = 0.0, a1 = 0.0, a2 = 0.0, a3 = 0.0;
+	double b0 = 0.0, b1 = 0.0, b2 = 0.0, b3 = 0.0;
+	double tmp;
+	
+	for(int i = Nmax-1; i>0; i--) {
+		if(i < Nmin) {
+			c0 = C0[i]; c1 = C1[i]; c2 = C2[i]; c3 = C3[i];
+		} else {
+			c0 = (i < N0) ? C0[i] : 0.0;
+			c1 = (i < N1) ? C1[i] : 0.0;
+			c2 = (i < N2) ? C2[i] : 0.0;
+			c3 = (i < N3) ? C3[i] : 0.0;
+		}
+		
+		tmp = t0*a0-b0+c0; b0 = a0; a0 = tmp;
+		tmp = t1*a1-b1+c1; b1 = a1; a1 = tmp;
+		tmp = t2*a2-b2+c2; b2 = a2; a2 = tmp;
+		tmp = t3*a3-b3+c3; b3 = a3; a3 = tmp;
+	}
+	
+	f1[0] = a0; f1[1] = a1; f1[2] = a2; f1[3] = a3;
+	f2[0] = b0; f2[1] = b1; f2[2] = b2; f2[3] = b3;
+#endif
+}
+
+// Clenshaw recursion of the three components at CHEB_LANES
+// normalized times. The coefficient of each step is the same for all
+// the lanes, so a single broadcast feeds the four of them, and the
+// three components are independent chains that overlap.
+static void epochs(int N, const double *tau, const double *Cx, const double *Cy, const double *Cz, double f[3][CHEB_LANES]) {
+#ifdef __AVX2__
+	__m256d t = _mm256_loadu_pd(tau);
+	__m256d t2 = _mm256_add_pd(t, t);
+	__m256d x1 = _mm256_setzero_pd(), x2 = x1, y1 = x1, y2 = x1, z1 = x1, z2 = x1, tmp;
+	
+	for(int i = N-1; i>0; i--) {
+		tmp = _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(t2, x1), x2), _mm256_broadcast_sd(&Cx[i]));
+		x2 = x1;
+		x1 = tmp;
+		tmp = _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(t2, y1), y2), _mm256_broadcast_sd(&Cy[i]));
+		y2 = y1;
+		y1 = tmp;
+		tmp = _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(t2, z1), z2), _mm256_broadcast_sd(&Cz[i]));
+		z2 = z1;
+		z1 = tmp;
+	}
+	
+	_mm256_storeu_pd(f[0], _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(t, x1), x2), _mm256_broadcast_sd(&Cx[0])));
+	_mm256_storeu_pd(f[1], _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(t, y1), y2), _mm256_broadcast_sd(&Cy[0])));
+	_mm256_storeu_pd(f[2], _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(t, z1), z2), _mm256_broadcast_sd(&Cz[0])));
+#else
+	const double *C[3] = {Cx, Cy, Cz};
+	double t0 = 2.0*tau[0], t1 = 2.0*tau[1], t2 = 2.0*tau[2], t3 = 2.0*tau[3];
+	
+	for(int j = 0; j < 3; j++) {
+		double a0 = 0.0, a1 = 0.0, a2 = 0.0, a3 = 0.0;
+		double b0 = 0.0, b1 = 0.0, b2 = 0.0, b3 = 0.0;
+		double c, tmp;
+		
+		for(int i = N-1; i>0; i--) {
+			c = C[j][i];
+			tmp = t0*a0-b0+c; b0 = a0; a0 = tmp;
+			tmp = t1*a1-b1+c; b1 = a1; a1 = tmp;
+			tmp = t2*a2-b2+c; b2 = a2; a2 = tmp;
+			tmp = t3*a3-b3+c; b3 = a3; a3 = tmp;
+		}
+		
+		f[j][0] = tau[0]*a0-b0+C[j][0];
+		f[j][1] = tau[1]*a1-b1+C[j][0];
+		f[j][2] = tau[2]*a2-b2+C[j][0];
+		f[j][3] = tau[3]*a3-b3+C[j][0];
+	}
+#endif
+}
+
+void Cheb_lanes(int n, const int *N, const double *tau, double *const *C, double *f) {
+	int Nl[CHEB_LANES];
+	double tl[CHEB_LANES], f1[CHEB_LANES], f2[CHEB_LANES];
+	double *Cl[CHEB_LANES];
+	
+	for(int l0 = 0; l0 < n; l0 += CHEB_LANES) {
+		int w = (n-l0 < CHEB_LANES) ? n-l0 : CHEB_LANES;
+		
+		// Unused lanes repeat the first series of the block
+		for(int l = 0; l < CHEB_LANES; l++) {
+			int k = l0 + ((l < w) ? l : 0);
+			
+			Nl[l] = N[k];
+			tl[l] = tau[k];
+			Cl[l] = C[k];
+		}
+		
+		lanes(Nl, tl, Cl, f1, f2);
+		
+		for(int l = 0; l < w; l++)
+			f[l0+l] = tl[l]*f1[l]-f2[l]+Cl[l][0];
+	}
+}
 
 double *Cheb3D(double t, int N, double Ta, double Tb, double *Cx, double *Cy, double *Cz) {
+	double *ChebApp = v_create(3);
+	
+	v3_store(Cheb3D_v3(t, N, Ta, Tb, Cx, Cy, Cz), ChebApp);
+	
+	return ChebApp;
+}
+
+Vec3 Cheb3D_v3(double t, int N, double Ta, double Tb, double *Cx, double *Cy, double *Cz) {
 	// Check validity
 	if((t<Ta) || (Tb<t)) {
 		printf("ERROR: Time out of range in Cheb3D::Value\n");
@@ -24,9 +180,9 @@ double *Cheb3D(double t, int N, double Ta, double Tb, double *Cx, double *Cy, do
 	// Clenshaw algorithm
 	double tau = (2.0*t-Ta-Tb)/(Tb-Ta);  
 
-	double *f1 = v_create(3);
-	double *f2 = v_create(3);
-	double *old_f1 = v_create(3);
+	double f1[3] = {0.0, 0.0, 0.0};
+	double f2[3] = {0.0, 0.0, 0.0};
+	double old_f1[3];
 
 	for(int i = N-1; i>0; i--) {
 		old_f1[0] = f1[0];
@@ -42,11 +198,39 @@ double *Cheb3D(double t, int N, double Ta, double Tb, double *Cx, double *Cy, do
 		f2[2] = old_f1[2];
 	}
 
-	double *ChebApp = v_create(3);
-	ChebApp[0] = tau*f1[0]-f2[0]+Cx[0];
-	ChebApp[1] = tau*f1[1]-f2[1]+Cy[0];
-	ChebApp[2] = tau*f1[2]-f2[2]+Cz[0];
+	Vec3 ChebApp;
+	ChebApp.v[0] = tau*f1[0]-f2[0]+Cx[0];
+	ChebApp.v[1] = tau*f1[1]-f2[1]+Cy[0];
+	ChebApp.v[2] = tau*f1[2]-f2[2]+Cz[0];
 	
 	return ChebApp;
 }
 
+void Cheb3D_batch(int m, const double *t, int N, double Ta, double Tb, double *Cx, double *Cy, double *Cz, Vec3 *r) {
+	double tau[CHEB_LANES], f[3][CHEB_LANES];
+	
+	for(int k0 = 0; k0 < m; k0 += CHEB_LANES) {
+		int w = (m-k0 < CHEB_LANES) ? m-k0 : CHEB_LANES;
+		
+		for(int k = 0; k < CHEB_LANES; k++) {
+			// Unused lanes repeat the first epoch of the block
+			double tk = t[k0 + ((k < w) ? k : 0)];
+			
+			// Check validity
+			if((tk<Ta) || (Tb<tk)) {
+				printf("ERROR: Time out of range in Cheb3D::Value\n");
+				exit(EXIT_FAILURE);
+			}
+			
+			tau[k] = (2.0*tk-Ta-Tb)/(Tb-Ta);
+		}
+		
+		epochs(N, tau, Cx, Cy, Cz, f);
+		
+		for(int k = 0; k < w; k++) {
+			r[k0+k].v[0] = f[0][k];
+			r[k0+k].v[1] = f[1][k];
+			r[k0+k].v[2] = f[2][k];
+		}
+	}
+}
@@ -0,0 +1,388 @@
+/** @file Cunningham.c
+ *  @brief Acceleration and gradient of the harmonic gravity field
+ *  by the Cunningham recursions.
+ *
+ *  This driver contains the code for the computation of the
+ *  acceleration due to the harmonic gravity field of the central
+ *  body and of its gradient.
+ *
+ *  The potential is U = GM/R*sum(Re((Cnm-i*Snm)*Znm)), with
+ *  Znm = Vnm+i*Wnm = (R/r)^(n+1)*Pnm(sin(lat))*exp(i*m*lon). In the
+ *  unnormalized functions the derivatives with respect to x/R, y/R
+ *  and z/R are ladders to degree n+1:
+ *
+ *    d/dx Znm = (-Zn+1,m+1 + (n-m+2)(n-m+1)*Zn+1,m-1)/2
+ *    d/dy Znm = i*(Zn+1,m+1 + (n-m+2)(n-m+1)*Zn+1,m-1)/2
+ *    d/dz Znm = -(n-m+1)*Zn+1,m
+ *
+ *  valid for negative orders too, with
+ *  Zn,-k = (-1)^k*(n-k)!/(n+k)!*conj(Zn,k). Applied twice they give
+ *  the gradient from degree n+2. The functions are evaluated fully
+ *  normalized. Every output is linear in the Zn,q, so the gravity
+ *  coefficients, the ladder factors and the ratios of normalization
+ *  factors are folded once into a complex weight per Zn,q and
+ *  output; an evaluation is then the recursion and one pass of
+ *  products over the table.
+ *
+ *  Vnm and Wnm share every recursion factor, so they are stored
+ *  side by side and advanced as one pair (one SSE2 register), and
+ *  the weights are stored as (re,-im) so that every output is the
+ *  dot product of a weight pair with a (Vnm,Wnm) pair. The
+ *  columns are advanced four at a time and the products summed in
+ *  two sets, so that the chains of dependent operations overlap.
+ *
+ *  @author Miguel Alonso Angulo.
+ *  @bug No known bugs.
+ */
+
+#include "../includes/Cunningham.h"
+#include "../includes/Legendre.h"
+#include "../includes/GravModel.h"
+#include "../includes/m_fixed.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Forced inlining of the kernels below, so that their lane counts
+// are constants and the lanes stay in registers
+#ifdef __GNUC__
+#define KERNEL inline __attribute__((always_inline))
+#else
+#define KERNEL inline
+#endif
+
+
+static int N = -1, M = -1;           // n_max, m_max of the tables
+static const GravModel *src = NULL;  // Model the weights were built from
+static long gen = -1;                // Generation of that model
+static double *Z = NULL;             // Normalized (Vnm,Wnm) up to N+2, M+2, per thread
+static int nz = 0;                   // Pairs in Z
+static double *a = NULL, *b = NULL;  // Column recursion factors up to N+2
+static double *dg = NULL;            // Diagonal recursion factor per order
+static double *wa = NULL;            // Weights of ax, ay, az per (n,q), re and -im
+static double *wg = NULL;            // Weights of gxx, gzz, gxy, gxz, gyz per (n,q), re and -im
+
+// Only the recursion is written by an evaluation, so each thread has
+// its own; the other tables are shared, and are read-only once set up
+#ifdef _OPENMP
+#pragma omp threadprivate(Z, nz)
+#endif
+
+// a!/b!
+static double fr(int a, int b) {
+	double f = 1.0;
+	
+	for(int i=b+1; i<=a; i++) {
+		f = f*i;
+	}
+	for(int i=a+1; i<=b; i++) {
+		f = f/i;
+	}
+	
+	return f;
+}
+
+// Nnm/Nn2,|q|, where Nnm^2 = (2-d0m)(2n+1)(n-m)!/(n+m)! is the
+// normalization factor. A negative order also carries the factor
+// (-1)^k*(n2-k)!/(n2+k)! that maps it onto conj(Zn2,k).
+static double ratio(int n, int m, int n2, int q) {
+	int k = abs(q);
+	double f = sqrt(((m == 0) ? 1.0 : 2.0)/((k == 0) ? 1.0 : 2.0)*(2.0*n+1)/(2.0*n2+1)
+					*fr(n-m,n2-k)*fr(n2+k,n+m));
+	
+	if(q < 0) {
+		f = f*((k%2) ? -1.0 : 1.0)*fr(n2-k,n2+k);
+	}
+	
+	return f;
+}
+
+// Add the term Re(u*Zn2,q) of an output to its weight; on a negative
+// order Re(u*conj(Zn2,k)) = Re(conj(u)*Zn2,k)
+static void fold(double *t, int stride, int out, int n2, int q, double ur, double ui) {
+	double *w = &t[stride*LEG_NM(n2,abs(q)) + 2*out];
+	
+	w[0] += ur;
+	w[1] += (q < 0) ? ui : -ui;
+}
+
+static double *table(int size) {
+	double *t = (double *) calloc(size, sizeof(double));
+	
+	if(t == NULL) {
+		printf("Cunningham: error\n");
+		exit(EXIT_FAILURE);
+	}
+	
+	return t;
+}
+
+// Tables for n_max, m_max, rebuilt only when the degree, the order
+// or the model change
+static void setup(int n_max, int m_max) {
+	const GravModel *g = GravModel_current();
+	
+	if(g == NULL || n_max > g->n) {
+		printf("Cunningham: error\n");
+		exit(EXIT_FAILURE);
+	}
+	if(N == n_max && M == m_max && gen == GravModel_generation()) {
+		return;
+	}
+	
+	free(a); free(b); free(dg); free(wa); free(wg);
+	
+	int size = LEG_NM(n_max+2,n_max+2)+1;
+	a = table(size);
+	b = table(size);
+	wa = table(6*size);
+	wg = table(10*size);
+	dg = table(n_max+3);
+	
+	for(int m=1; m<=n_max+2; m++) {
+		dg[m] = sqrt(((m == 1) ? 2.0 : 1.0)*(2.0*m+1)/(2.0*m));
+	}
+	for(int n=1; n<=n_max+2; n++) {
+		for(int m=0; m<n; m++) {
+			a[LEG_NM(n,m)] = sqrt((2.0*n+1)*(2.0*n-1)/((n-m)*(n+m)));
+			b[LEG_NM(n,m)] = sqrt((2.0*n+1)*(n+m-1)*(n-m-1)/((2.0*n-3)*(n+m)*(n-m)));
+		}
+	}
+	
+	for(int n=0; n<=n_max; n++) {
+		for(int m=0; m<=m_max && m<=n; m++) {
+			double cr = GRAV_C(g,n,m), ci = -GRAV_S(g,n,m);   // Cnm-i*Snm
+			double f = (n-m+2)*(n-m+1), h = n-m+1, k;
+			
+			// ax = Re(c*(k0*Zn+1,m-1 - k2*Zn+1,m+1))
+			// ay = Re(i*c*(k0*Zn+1,m-1 + k2*Zn+1,m+1))
+			// az = Re(-c*k1*Zn+1,m)
+			k = 0.5*f*ratio(n,m,n+1,m-1);
+			fold(wa,6,0,n+1,m-1,cr*k,ci*k);
+			fold(wa,6,1,n+1,m-1,-ci*k,cr*k);
+			k = h*ratio(n,m,n+1,m);
+			fold(wa,6,2,n+1,m,-cr*k,-ci*k);
+			k = 0.5*ratio(n,m,n+1,m+1);
+			fold(wa,6,0,n+1,m+1,-cr*k,-ci*k);
+			fold(wa,6,1,n+1,m+1,-ci*k,cr*k);
+			
+			// gxx = Re(c*(k4*Zn+2,m+2 - k2/2*Zn+2,m + k0*Zn+2,m-2))
+			// gzz = Re(c*k2*Zn+2,m)
+			// gxy = Re(-i*c*(k4*Zn+2,m+2 - k0*Zn+2,m-2))
+			// gxz = Re(c*(k3*Zn+2,m+1 - k1*Zn+2,m-1))
+			// gyz = Re(-i*c*(k3*Zn+2,m+1 + k1*Zn+2,m-1))
+			k = 0.25*f*(n-m+4)*(n-m+3)*ratio(n,m,n+2,m-2);
+			fold(wg,10,0,n+2,m-2,cr*k,ci*k);
+			fold(wg,10,2,n+2,m-2,-ci*k,cr*k);
+			k = 0.5*f*(n-m+3)*ratio(n,m,n+2,m-1);
+			fold(wg,10,3,n+2,m-1,-cr*k,-ci*k);
+			fold(wg,10,4,n+2,m-1,ci*k,-cr*k);
+			k = f*ratio(n,m,n+2,m);
+			fold(wg,10,0,n+2,m,-0.5*cr*k,-0.5*ci*k);
+			fold(wg,10,1,n+2,m,cr*k,ci*k);
+			k = 0.5*(n-m+1)*ratio(n,m,n+2,m+1);
+			fold(wg,10,3,n+2,m+1,cr*k,ci*k);
+			fold(wg,10,4,n+2,m+1,ci*k,-cr*k);
+			k = 0.25*ratio(n,m,n+2,m+2);
+			fold(wg,10,0,n+2,m+2,cr*k,ci*k);
+			fold(wg,10,2,n+2,m+2,ci*k,-cr*k);
+		}
+	}
+	
+	N = n_max;
+	M = m_max;
+	src = g;
+	gen = GravModel_generation();
+}
+
+// Columns m to m+l-1 (l <= 4) from their diagonal down to degree nn,
+// in lock-step so that their chains overlap. Row n of the block is
+// contiguous from LEG_NM(n,m), and bnm is zero on the first step of
+// every column.
+static KERNEL void columns(int m, int l, int nn, double z0, double rho) {
+	int k = LEG_NM(m,m);
+	
+#ifdef __SSE2__
+	__m128d z1[4], z2[4], z;
+	
+	for(int j=0; j<l; j++) {
+		z1[j] = _mm_loadu_pd(&Z[2*LEG_NM(m+j,m+j)]);
+		z2[j] = _mm_setzero_pd();
+	}
+	for(int n=m+1; n<=nn; n++) {
+		k = k+n;   // LEG_NM(n,m)
+		#pragma GCC unroll 4
+		for(int j=0; j<l; j++) {
+			if(m+j < n) {
+				z = _mm_sub_pd(_mm_mul_pd(_mm_set1_pd(a[k+j]*z0), z1[j]),
+							   _mm_mul_pd(_mm_set1_pd(b[k+j]*rho), z2[j]));
+				_mm_storeu_pd(&Z[2*(k+j)], z);
+				z2[j] = z1[j];
+				z1[j] = z;
+			}
+		}
+	}
+#else
+	double v1[4], w1[4], v2[4], w2[4], v, w;
+	
+	for(int j=0; j<l; j++) {
+		v1[j] = Z[2*LEG_NM(m+j,m+j)];
+		w1[j] = Z[2*LEG_NM(m+j,m+j)+1];
+		v2[j] = w2[j] = 0.0;
+	}
+	for(int n=m+1; n<=nn; n++) {
+		k = k+n;   // LEG_NM(n,m)
+		#pragma GCC unroll 4
+		for(int j=0; j<l; j++) {
+			if(m+j < n) {
+				v = a[k+j]*z0*v1[j] - b[k+j]*rho*v2[j];
+				w = a[k+j]*z0*w1[j] - b[k+j]*rho*w2[j];
+				Z[2*(k+j)] = v;
+				Z[2*(k+j)+1] = w;
+				v2[j] = v1[j]; w2[j] = w1[j];
+				v1[j] = v;     w1[j] = w;
+			}
+		}
+	}
+#endif
+}
+
+// Adds to s[0..l-1] the products of the weights t, l pairs per
+// term, with the (Vnm,Wnm) of the terms k0 to k1. Even and odd
+// terms go to separate sums.
+static KERNEL void dot(const double *t, int l, int k0, int k1, double *s) {
+	int k;
+	
+#ifdef __SSE2__
+	__m128d e[5], o[5], z, y;
+	
+	for(int j=0; j<l; j++) {
+		e[j] = o[j] = _mm_setzero_pd();
+	}
+	for(k=k0; k<k1; k+=2) {
+		const double *w = &t[2*l*k];
+		
+		z = _mm_loadu_pd(&Z[2*k]);
+		y = _mm_loadu_pd(&Z[2*k+2]);
+		#pragma GCC unroll 5
+		for(int j=0; j<l; j++) {
+			e[j] = _mm_add_pd(e[j], _mm_mul_pd(_mm_loadu_pd(&w[2*j]), z));
+			o[j] = _mm_add_pd(o[j], _mm_mul_pd(_mm_loadu_pd(&w[2*l+2*j]), y));
+		}
+	}
+	if(k == k1) {
+		z = _mm_loadu_pd(&Z[2*k]);
+		#pragma GCC unroll 5
+		for(int j=0; j<l; j++) {
+			e[j] = _mm_add_pd(e[j], _mm_mul_pd(_mm_loadu_pd(&t[2*l*k+2*j]), z));
+		}
+	}
+	for(int j=0; j<l; j++) {
+		double h[2];
+		
+		_mm_storeu_pd(h, _mm_add_pd(e[j], o[j]));
+		s[j] += h[0] + h[1];
+	}
+#else
+	for(k=k0; k<=k1; k++) {
+		const double *w = &t[2*l*k];
+		
+		for(int j=0; j<l; j++) {
+			s[j] += w[2*j]*Z[2*k] + w[2*j+1]*Z[2*k+1];
+		}
+	}
+#endif
+}
+
+Vec3 Cunningham(Vec3 r, Mat3 E, int n_max, int m_max, Mat3 *G) {
+	if(m_max > n_max) {
+		m_max = n_max;
+	}
+	setup(n_max,m_max);
+	if(nz < LEG_NM(N+2,N+2)+1) {
+		free(Z);
+		nz = LEG_NM(N+2,N+2)+1;
+		Z = table(2*nz);
+	}
+	double r_ref = src->r_ref;
+	double gm    = src->gm;
+	
+	// Body-fixed position 
+	Vec3 r_bf = m3_dot_v3(E,r);
+	
+	// Auxiliary quantities
+	double rr = v3_dot(r_bf,r_bf);
+	double rho = r_ref*r_ref/rr;
+	double x0 = r_ref*r_bf.v[0]/rr;
+	double y0 = r_ref*r_bf.v[1]/rr;
+	double z0 = r_ref*r_bf.v[2]/rr;
+	
+	// Normalized V and W; one degree more for the gradient
+	int nn = n_max + ((G != NULL) ? 2 : 1);
+	int mm = m_max + ((G != NULL) ? 2 : 1);
+	
+	Z[0] = r_ref/sqrt(rr);
+	Z[1] = 0.0;
+	for(int m=1; m<=mm; m++) {
+		int k = LEG_NM(m,m), k1 = LEG_NM(m-1,m-1);
+		
+		Z[2*k]   = dg[m]*(x0*Z[2*k1] - y0*Z[2*k1+1]);
+		Z[2*k+1] = dg[m]*(x0*Z[2*k1+1] + y0*Z[2*k1]);
+	}
+	int m = 0;
+	for(; m+3<=mm; m+=4) {
+		columns(m,4,nn,z0,rho);
+	}
+	for(; m<=mm; m++) {
+		columns(m,1,nn,z0,rho);
+	}
+	
+	// Outputs as Re(weight*Zn,q), the whole triangle at once for the
+	// full field
+	double sa[3] = {0.0, 0.0, 0.0};
+	
+	if(m_max == n_max) {
+		dot(wa,3,1,LEG_NM(n_max+1,n_max+1),sa);
+	}
+	else {
+		for(int n=1; n<=n_max+1; n++) {
+			dot(wa,3,LEG_NM(n,0),LEG_NM(n,(n < m_max+1) ? n : m_max+1),sa);
+		}
+	}
+	
+	if(G != NULL) {
+		double sg[5] = {0.0, 0.0, 0.0, 0.0, 0.0};   // gxx, gzz, gxy, gxz, gyz
+		
+		if(m_max == n_max) {
+			dot(wg,5,LEG_NM(2,0),LEG_NM(n_max+2,n_max+2),sg);
+		}
+		else {
+			for(int n=2; n<=n_max+2; n++) {
+				dot(wg,5,LEG_NM(n,0),LEG_NM(n,(n < m_max+2) ? n : m_max+2),sg);
+			}
+		}
+		
+		// Laplace's equation
+		double gyy = -sg[0]-sg[1];
+		
+		double s2 = gm/(r_ref*r_ref*r_ref);
+		Mat3 G_bf = {{{s2*sg[0], s2*sg[2], s2*sg[3]},
+					  {s2*sg[2], s2*gyy,   s2*sg[4]},
+					  {s2*sg[3], s2*sg[4], s2*sg[1]}}};
+		
+		// Inertial gradient
+		*G = m3_dot(m3_trans(E),m3_dot(G_bf,E));
+	}
+	
+	// Body-fixed acceleration
+	double s1 = gm/(r_ref*r_ref);
+	Vec3 a_bf = {{s1*sa[0], s1*sa[1], s1*sa[2]}};
+	
+	// Inertial acceleration
+	return m3_trans_dot_v3(E,a_bf);
+}
@@ -0,0 +1,183 @@
+/** @file EarthRot.c
+ *  @brief Earth rotation provider code driver.
+ *
+ *  This driver contains the code for the per-arc precomputation
+ *  and interpolation of the Earth rotation matrices.
+ *
+ *  @author Miguel Alonso Angulo.
+ *  @bug No know bugs.
+ */
+
+#include "../includes/EarthRot.h"
+#include "../includes/const.h"
+#include "../includes/m_utils.h"
+#include "../includes/m_fixed.h"
+#include "../includes/PrecMatrix.h"
+#include "../includes/NutMatrix.h"
+#include "../includes/GHAMatrix.h"
+#include "../includes/EqnEquinox.h"
+#include "../includes/gmst.h"
+#include "../includes/R_z.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define NODE 10         // Values per node: N*P (9) and equation of the equinoxes
+
+
+static EarthRot *bound = NULL;
+
+static Mat3 NP_exact(double Mjd_TT) {
+	return m3_dot(NutMatrix(Mjd_TT),PrecMatrix((MJD_J2000),Mjd_TT));
+}
+
+// Cubic Lagrange weights of the nodes i-1..i+2 at t. Returns i, or -1
+// if t is outside the arc.
+static int weights(EarthRot *er, double t, double *w) {
+	double x = (t-er->t0)/er->h;
+	int i = (int) floor(x);
+	
+	if(x != x || i < 1 || i > er->n-3) {
+		return -1;
+	}
+	
+	x = x-i;
+	w[0] = -x*(x-1)*(x-2)/6.0;
+	w[1] = (x+1)*(x-1)*(x-2)/2.0;
+	w[2] = -(x+1)*x*(x-2)/2.0;
+	w[3] = (x+1)*x*(x-1)/6.0;
+	
+	return i;
+}
+
+// Interpolated values k0..k1-1 of the node layout at t
+static int interp(EarthRot *er, double t, double *y, int k0, int k1) {
+	double w[4];
+	int i = weights(er, t, w);
+	
+	if(i < 0) {
+		return 0;
+	}
+	
+	double *p = &er->node[(i-1)*NODE];
+	for(int k=k0; k<k1; k++) {
+		y[k] = w[0]*p[k] + w[1]*p[k+NODE] + w[2]*p[k+2*NODE] + w[3]*p[k+3*NODE];
+	}
+	
+	return 1;
+}
+
+static void exact(double t, double *y) {
+	Mat3 NP = NP_exact(t);
+	
+	for(int i=0; i<3; i++) {
+		for(int j=0; j<3; j++) {
+			y[3*i+j] = NP.m[i][j];
+		}
+	}
+	y[9] = EqnEquinox(t);
+}
+
+EarthRot *EarthRot_create(double Mjd_first, double Mjd_last, double tol) {
+	EarthRot *er = (EarthRot *) malloc(sizeof(EarthRot));
+	double y[NODE], yi[NODE];
+	
+	if(er == NULL || Mjd_last < Mjd_first) {
+		printf("EarthRot: error\n");
+		exit(EXIT_FAILURE);
+	}
+	
+	er->tol = tol;
+	er->h = 1.0;
+	while(1) {
+		// Two nodes of margin at each side cover the TT and UT1 offsets
+		er->t0 = Mjd_first - 2.0*er->h;
+		er->n = (int) ceil((Mjd_last-Mjd_first)/er->h) + 5;
+		er->node = v_create(er->n*NODE);
+		for(int i=0; i<er->n; i++) {
+			exact(er->t0 + i*er->h, &er->node[i*NODE]);
+		}
+		
+		// The error of cubic interpolation peaks at the middle of the interval
+		er->err = 0.0;
+		for(int i=1; i<=er->n-3; i++) {
+			double t = er->t0 + (i+0.5)*er->h;
+			
+			exact(t, y);
+			interp(er, t, yi, 0, NODE);
+			for(int k=0; k<NODE; k++) {
+				if(fabs(y[k]-yi[k]) > er->err) {
+					er->err = fabs(y[k]-yi[k]);
+				}
+			}
+		}
+		
+		if(er->err <= tol) {
+			break;
+		}
+		
+		v_free(er->node, er->n*NODE);
+		er->h = er->h/2.0;
+		if(er->h < 1.0/1440.0) {
+			printf("EarthRot: tolerance not reached\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	
+	return er;
+}
+
+void EarthRot_free(EarthRot *er) {
+	if(bound == er) {
+		bound = NULL;
+	}
+	
+	v_free(er->node, er->n*NODE);
+	free(er);
+}
+
+Mat3 EarthRot_NP(EarthRot *er, double Mjd_TT) {
+	double y[NODE];
+	Mat3 NP;
+	
+	if(er == NULL || !interp(er, Mjd_TT, y, 0, 9)) {
+		return NP_exact(Mjd_TT);
+	}
+	
+	for(int i=0; i<3; i++) {
+		for(int j=0; j<3; j++) {
+			NP.m[i][j] = y[3*i+j];
+		}
+	}
+	
+	return NP;
+}
+
+Mat3 EarthRot_GHA(EarthRot *er, double Mjd_UT1) {
+	double y[NODE];
+	
+	if(er == NULL || !interp(er, Mjd_UT1, y, 9, NODE)) {
+		return GHAMatrix(Mjd_UT1);
+	}
+	
+	// Greenwich apparent sidereal time, as in gast
+	double gstime = fmod(gmst(Mjd_UT1) + y[9], 2.0*M_PI);
+	
+	if(gstime < 0)
+		gstime = gstime + 2.0*M_PI;
+	
+	return R_z(gstime);
+}
+
+EarthRot *EarthRot_bind(EarthRot *er) {
+	EarthRot *old = bound;
+	
+	bound = er;
+	
+	return old;
+}
+
+EarthRot *EarthRot_current(void) {
+	return bound;
+}
@@ -16,7 +16,7 @@
 #include <stdio.h>
 
 
-double **GHAMatrix(double Mjd_UT1) {
+Mat3 GHAMatrix(double Mjd_UT1) {
 	return R_z(gast(Mjd_UT1));
 }
 
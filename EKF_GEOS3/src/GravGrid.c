@@ -0,0 +1,367 @@
+/** @file GravGrid.c
+ *  @brief Precomputed gravity grid code driver.
+ *
+ *  This driver contains the code for the computation, storage and
+ *  interpolation of the precomputed gravity grid.
+ *
+ *  @author Miguel Alonso Angulo.
+ *  @bug No know bugs.
+ */
+
+#include "../includes/GravGrid.h"
+#include "../includes/AccelHarmonic.h"
+#include "../includes/Cunningham.h"
+#include "../includes/GravModel.h"
+#include "../includes/m_fixed.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/stat.h>
+
+// The grid file is mapped where mmap exists, and read in elsewhere
+// (MinGW)
+#if defined(__unix__) || defined(__APPLE__)
+#define GRAVGRID_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#define GRAVGRID_MAGIC "GRAVGRID"
+#define CHECKS 4096     // Cells whose middle is checked against the full model
+
+
+static GravGrid *bound = NULL;
+
+// FNV-1a hash of the bytes of x into h
+static unsigned long long fnv(unsigned long long h, const double *x, size_t k) {
+	const unsigned char *c = (const unsigned char *) x;
+
+	for(size_t i=0; i<k*sizeof(double); i++) {
+		h = (h ^ c[i])*1099511628211ULL;
+	}
+
+	return h;
+}
+
+// Hash of the model constants and of the coefficients up to n_max, m_max
+static unsigned long long coeffs(const GravModel *model, int n_max, int m_max) {
+	unsigned long long h = 14695981039346656037ULL;
+
+	h = fnv(h, &model->gm, 1);
+	h = fnv(h, &model->r_ref, 1);
+	for(int n=0; n<=n_max; n++) {
+		int mm = (m_max < n) ? m_max : n;
+
+		h = fnv(h, &GRAV_C(model,n,0), 2*(mm+1));
+	}
+
+	return h;
+}
+
+// Acceleration without the central term at a body-fixed point
+static Vec3 field(const GravGrid *g, double d, double lat, double lon) {
+	Vec3 r = {{d*cos(lat)*cos(lon), d*cos(lat)*sin(lon), d*sin(lat)}};
+	Vec3 a = Cunningham(r, m3_eye(), g->n, g->m, NULL);
+
+	return v3_sum(a, v3_mul_scalar(r, g->gm/(d*d*d)));
+}
+
+// Cubic Lagrange weights of the nodes -1..2 at x in [0,1]
+static void lagrange(double x, double *w) {
+	w[0] = -x*(x-1)*(x-2)/6.0;
+	w[1] = (x+1)*(x-1)*(x-2)/2.0;
+	w[2] = -(x+1)*x*(x-2)/2.0;
+	w[3] = (x+1)*x*(x-1)/6.0;
+}
+
+// Interpolated acceleration without the central term; node i of an
+// axis with ghosts is at i-1 of the axis without them
+static Vec3 interp(const GravGrid *g, double d, double lat, double lon) {
+	double wr[4], wl[4], wo[4];
+	double u = (d-g->r0)/g->dr, v = (lat+M_PI/2)/g->dlat, w = (lon+M_PI)/g->dlon;
+	int i = (int) floor(u), j = (int) floor(v), k = (int) floor(w), kk[4];
+
+	i = (i < 0) ? 0 : (i > g->nr-2) ? g->nr-2 : i;
+	j = (j < 0) ? 0 : (j > g->nlat-2) ? g->nlat-2 : j;
+	lagrange(u-i, wr);
+	lagrange(v-j, wl);
+	lagrange(w-k, wo);
+	for(int c=0; c<4; c++) {
+		kk[c] = ((k-1+c) % g->nlon + g->nlon) % g->nlon;
+	}
+
+	Vec3 a = {{0.0, 0.0, 0.0}};
+	for(int p=0; p<4; p++) {
+		for(int q=0; q<4; q++) {
+			double wpq = wr[p]*wl[q];
+			const double *row = &g->node[3*((size_t) (i+p)*(g->nlat+2) + j+q)*g->nlon];
+
+			for(int c=0; c<4; c++) {
+				const double *n = &row[3*kk[c]];
+				double wc = wpq*wo[c];
+
+				a.v[0] += wc*n[0];
+				a.v[1] += wc*n[1];
+				a.v[2] += wc*n[2];
+			}
+		}
+	}
+
+	return a;
+}
+
+// Nodes of every shell into the grid, the shells shared among the
+// threads where there is OpenMP. The first evaluation sets up the
+// tables of Cunningham, so that the threads only read them.
+static void shells(GravGrid *g, double *node) {
+	field(g, g->r0, 0.0, 0.0);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+	for(int i=0; i<g->nr+2; i++) {
+		for(int j=0; j<g->nlat+2; j++) {
+			for(int k=0; k<g->nlon; k++) {
+				Vec3 a = field(g, g->r0+(i-1)*g->dr, -M_PI/2+(j-1)*g->dlat, -M_PI+k*g->dlon);
+
+				v3_store(a, &node[3*(((size_t) i*(g->nlat+2) + j)*g->nlon + k)]);
+			}
+		}
+	}
+}
+
+// Largest interpolation error at the middle of CHECKS cells spread
+// over the grid
+static double check(const GravGrid *g) {
+	long cells = (long) (g->nr-1)*(g->nlat-1)*g->nlon;
+	double err = 0.0;
+
+	for(long c=0; c<CHECKS; c++) {
+		long k = (c*cells)/CHECKS;
+		double d = g->r0 + (k/((long) (g->nlat-1)*g->nlon) + 0.5)*g->dr;
+		double lat = -M_PI/2 + ((k/g->nlon)%(g->nlat-1) + 0.5)*g->dlat;
+		double lon = -M_PI + (k%g->nlon + 0.5)*g->dlon;
+		double e = v3_norm(v3_sub(field(g, d, lat, lon), interp(g, d, lat, lon)));
+
+		if(e > err) {
+			err = e;
+		}
+	}
+
+	return err;
+}
+
+// Header of the grid g, built from the model of the given hash, is in h
+static int same(const GravGrid *g, const GravGridHeader *h, unsigned long long hash) {
+	return memcmp(h->magic, GRAVGRID_MAGIC, 8) == 0 && h->n == g->n && h->m == g->m &&
+		   h->nr == g->nr && h->nlat == g->nlat && h->nlon == g->nlon &&
+		   h->r0 == g->r0 && h->r1 == g->r1 && h->coeffs == hash;
+}
+
+#ifdef GRAVGRID_MMAP
+// Map the grid file. Returns 0 if there is no usable grid.
+static int map(GravGrid *g, const char *file, unsigned long long hash) {
+	struct stat sb;
+
+	int fd = open(file, O_RDONLY);
+	if(fd < 0) {
+		return 0;
+	}
+
+	if(fstat(fd,&sb) != 0 || (size_t) sb.st_size != g->size) {
+		close(fd);
+		return 0;
+	}
+
+	void *p = mmap(NULL, g->size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(p == MAP_FAILED) {
+		return 0;
+	}
+
+	GravGridHeader *h = (GravGridHeader *) p;
+	if(!same(g, h, hash)) {
+		munmap(p, g->size);
+		return 0;
+	}
+
+	g->map = p;
+	g->node = (const double *) (h + 1);
+	g->err = h->err;
+
+	return 1;
+}
+#else
+// Read the grid file in. Returns 0 if there is no usable grid.
+static int map(GravGrid *g, const char *file, unsigned long long hash) {
+	struct stat sb;
+
+	if(stat(file,&sb) != 0 || (size_t) sb.st_size != g->size) {
+		return 0;
+	}
+
+	FILE *fp = fopen(file,"rb");
+	if(fp == NULL) {
+		return 0;
+	}
+
+	void *p = malloc(g->size);
+	if(p == NULL) {
+		printf("GravGrid: error\n");
+		exit(EXIT_FAILURE);
+	}
+
+	GravGridHeader *h = (GravGridHeader *) p;
+	if(fread(p, 1, g->size, fp) != g->size || !same(g, h, hash)) {
+		free(p);
+		fclose(fp);
+		return 0;
+	}
+	fclose(fp);
+
+	g->map = p;
+	g->node = (const double *) (h + 1);
+	g->err = h->err;
+
+	return 1;
+}
+#endif
+
+// Compute the grid in memory and store it into a temporary file
+// renamed over the grid file at the end, so other processes never
+// read a partial grid.
+static void build(GravGrid *g, const char *file, unsigned long long hash) {
+	char tmp[1024];
+	GravGridHeader h;
+
+	void *p = malloc(g->size);
+	if(p == NULL) {
+		printf("GravGrid: error\n");
+		exit(EXIT_FAILURE);
+	}
+	double *node = (double *) ((GravGridHeader *) p + 1);
+
+	shells(g, node);
+	g->node = node;
+	g->err = check(g);
+
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, GRAVGRID_MAGIC, 8);
+	h.n = g->n;
+	h.m = g->m;
+	h.nr = g->nr;
+	h.nlat = g->nlat;
+	h.nlon = g->nlon;
+	h.r0 = g->r0;
+	h.r1 = g->r1;
+	h.err = g->err;
+	h.coeffs = hash;
+	memcpy(p, &h, sizeof(h));
+	g->map = p;
+
+#ifdef GRAVGRID_MMAP
+	snprintf(tmp, sizeof(tmp), "%s.%d", file, (int) getpid());
+#else
+	snprintf(tmp, sizeof(tmp), "%s.tmp", file);
+#endif
+
+	// A grid that cannot be stored is still used by this run
+	FILE *fp = fopen(tmp,"wb");
+	if(fp == NULL) {
+		return;
+	}
+	int ok = fwrite(p, 1, g->size, fp) == g->size;
+	ok = (fclose(fp) == 0) && ok;
+
+#ifndef GRAVGRID_MMAP
+	// rename does not replace an existing file there
+	remove(file);
+#endif
+	if(!ok || rename(tmp, file) != 0) {
+		remove(tmp);
+	}
+}
+
+GravGrid *GravGrid_create(const char *file, int n_max, int m_max, double r0, double r1,
+						  int nr, int nlat, int nlon) {
+	GravGrid *g = (GravGrid *) malloc(sizeof(GravGrid));
+
+	if(g == NULL || nr < 2 || nlat < 3 || nlon < 4 || r1 <= r0 || r0 <= 0.0) {
+		printf("GravGrid: error\n");
+		exit(EXIT_FAILURE);
+	}
+
+	g->n = n_max;
+	g->m = (m_max < n_max) ? m_max : n_max;
+	g->nr = nr;
+	g->nlat = nlat;
+	g->nlon = nlon;
+	g->r0 = r0;
+	g->r1 = r1;
+	g->dr = (r1-r0)/(nr-1);
+	g->dlat = M_PI/(nlat-1);
+	g->dlon = 2.0*M_PI/nlon;
+	g->size = sizeof(GravGridHeader) + 3*sizeof(double)*(size_t) (nr+2)*(nlat+2)*nlon;
+
+	const GravModel *model = GravModel_current();
+	if(model == NULL || n_max > model->n) {
+		printf("GravGrid: error\n");
+		exit(EXIT_FAILURE);
+	}
+	g->gm = model->gm;
+
+	unsigned long long hash = coeffs(model, g->n, g->m);
+	g->built = !map(g, file, hash);
+	if(g->built) {
+		build(g, file, hash);
+	}
+
+	return g;
+}
+
+void GravGrid_free(GravGrid *g) {
+#ifdef GRAVGRID_MMAP
+	if(!g->built) {
+		munmap(g->map, g->size);
+	} else {
+		free(g->map);
+	}
+#else
+	free(g->map);
+#endif
+	free(g);
+}
+
+Vec3 GravGrid_accel(const GravGrid *g, Vec3 r, Mat3 E) {
+	// Body-fixed position
+	Vec3 r_bf = m3_dot_v3(E,r);
+	double d = v3_norm(r_bf);
+
+	if(d < g->r0 || d > g->r1) {
+		return AccelHarmonic(r, E, g->n, g->m);
+	}
+
+	double lat = asin(r_bf.v[2]/d);
+	double lon = atan2(r_bf.v[1],r_bf.v[0]);
+
+	// Body-fixed acceleration: central term and interpolated remainder
+	Vec3 a_bf = v3_sum(interp(g, d, lat, lon), v3_mul_scalar(r_bf, -g->gm/(d*d*d)));
+
+	// Inertial acceleration
+	return m3_trans_dot_v3(E,a_bf);
+}
+
+GravGrid *GravGrid_bind(GravGrid *g) {
+	GravGrid *old = bound;
+
+	bound = g;
+
+	return old;
+}
+
+GravGrid *GravGrid_current(void) {
+	return bound;
+}
@@ -0,0 +1,135 @@
+/** @file GravModel.c
+ *  @brief Gravity field model code driver.
+ *
+ *  This driver contains the code for the loading of the gravity
+ *  field models.
+ *
+ *  @author Miguel Alonso Angulo.
+ *  @bug No know bugs.
+ */
+
+#include "../includes/GravModel.h"
+#include "../includes/Legendre.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+
+static GravModel *bound = NULL;
+static long generation = 0;   // Loads and binds so far
+
+// Numbers from p on with Fortran exponents, 1.0D-06, made readable
+// by strtod
+static char *fortran(char *p) {
+	for(char *q=p; *q != '\0'; q++) {
+		if(*q == 'D' || *q == 'd') {
+			*q = 'e';
+		}
+	}
+
+	return p;
+}
+
+GravModel *GravModel_load(const char *file, int n_max) {
+	GravModel *g = (GravModel *) malloc(sizeof(GravModel));
+	size_t size = 2*sizeof(double)*(LEG_NM(n_max,n_max)+1);
+
+	// Over-allocated and aligned by hand, since aligned_alloc is not
+	// in every C library (MinGW's msvcrt lacks it)
+	if(g == NULL || n_max < 0 || (g->block = malloc(size + GRAV_ALIGN-1)) == NULL) {
+		printf("GravModel: error\n");
+		exit(EXIT_FAILURE);
+	}
+	g->cs = (double *) (((uintptr_t) g->block + GRAV_ALIGN-1) & ~((uintptr_t) GRAV_ALIGN-1));
+	memset(g->cs, 0, size);
+	g->n = n_max;
+	g->gm = 398600.4415e9;   // [m^3/s^2]; GGM03S
+	g->r_ref = 6378.1363e3;  // Earth's radius [m]; GGM03S
+
+	FILE *fp = fopen(file,"r");
+	if(fp == NULL) {
+		printf("Fail open %s file\n", file);
+		exit(EXIT_FAILURE);
+	}
+
+	// Coefficients read, so that a missing one is reported, and the
+	// reading stops once they are all in
+	int left = LEG_NM(n_max,n_max)+1;
+	char *seen = (char *) calloc(LEG_NM(n_max,n_max)+1, 1);
+	if(seen == NULL) {
+		printf("GravModel: error\n");
+		exit(EXIT_FAILURE);
+	}
+
+	char line[256], *p, *e;
+	while(fgets(line, sizeof(line), fp) != NULL) {
+		p = line;
+		if(strncmp(p,"earth_gravity_constant",22) == 0) {
+			g->gm = strtod(fortran(p+22), NULL);
+			continue;
+		}
+		if(strncmp(p,"radius",6) == 0) {
+			g->r_ref = strtod(fortran(p+6), NULL);
+			continue;
+		}
+		if(strncmp(p,"gfc",3) == 0) {
+			p = p+3;
+		}
+
+		// Rows start with the degree; anything else is header
+		long n = strtol(p, &e, 10);
+		if(e == p || (*e != ' ' && *e != '\t')) {
+			continue;
+		}
+		long m = strtol(e, &p, 10);
+		if(n < 0 || n > n_max || m < 0 || m > n) {
+			continue;
+		}
+		GRAV_C(g,n,m) = strtod(fortran(p), &e);
+		GRAV_S(g,n,m) = strtod(e, NULL);
+		if(!seen[LEG_NM(n,m)]) {
+			seen[LEG_NM(n,m)] = 1;
+			if(--left == 0) {
+				break;
+			}
+		}
+	}
+
+	fclose(fp);
+	free(seen);
+	if(left > 0) {
+		printf("GravModel: %d coefficients missing in %s\n", left, file);
+		exit(EXIT_FAILURE);
+	}
+	generation++;
+
+	return g;
+}
+
+void GravModel_free(GravModel *g) {
+	if(g == bound) {
+		bound = NULL;
+		generation++;
+	}
+	free(g->block);
+	free(g);
+}
+
+GravModel *GravModel_bind(GravModel *g) {
+	GravModel *old = bound;
+
+	bound = g;
+	generation++;
+
+	return old;
+}
+
+GravModel *GravModel_current(void) {
+	return bound;
+}
+
+long GravModel_generation(void) {
+	return generation;
+}
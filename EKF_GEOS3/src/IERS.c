@@ -10,65 +10,79 @@
 
 #include "../includes/const.h"
 #include "../includes/global.h"
-#include "../includes/m_utils.h"
+#include "../includes/IERS.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 
 
-void IERS(double Mjd_UTC, char interp,
-			double *x_pole, double *y_pole, double *UT1_UTC,
-			double *LOD, double *dpsi, double *deps, double *dx_pole,
-			double *dy_pole, double *TAI_UTC) {
+// Linear interpolation between the columns i and i+1 of a row
+static double lerp(double *row, int i, double fixf) {
+	return row[i]+(row[i+1]-row[i])*fixf;
+}
+
+void IERS_eop(double Mjd_UTC, char interp, EOP *eop) {
 	extern double** eopdata;
+	extern int ceopdata;
 
+	// eopdata is a daily series: the column of a day is its offset
+	// from the first day
 	double mjd = floor(Mjd_UTC);
-	int i = 0;
-	for(int j=0; j<ceopdata; j++) {
-		if(mjd==eopdata[3][j]) {
-			i = j++;
-			break;
-		}
-	}
-	if(i == 0) {
+	int i = (int) (mjd - eopdata[3][0]);
+	int last = (interp == 'l') ? i+1 : i;
+	if(mjd < eopdata[3][0] || last >= ceopdata || eopdata[3][i] != mjd) {
 		printf("IERS: Not find mjd\n");
         exit(EXIT_FAILURE);
 	}
 
 	if(interp =='l') {
 		// linear interpolation
-		double *preeop = v_extract(eopdata,feopdata,ceopdata,i);
-		double *nexteop = v_extract(eopdata,feopdata,ceopdata,i+1);
 		double mfme = 1440.0*(Mjd_UTC-floor(Mjd_UTC));
 		double fixf = mfme/1440.0;
-
+		
 		// Setting of IERS Earth rotation parameters
 		// (UT1-UTC [s], TAI-UTC [s], x ["], y ["])
-		*x_pole  = (preeop[4]+(nexteop[4]-preeop[4])*fixf)/(Arcs); // Pole coordinate [rad]
-		*y_pole  = (preeop[5]+(nexteop[5]-preeop[5])*fixf)/(Arcs); // Pole coordinate [rad]
-		*UT1_UTC = (preeop[6]+(nexteop[6]-preeop[6])*fixf);
-		*LOD     = (preeop[7]+(nexteop[7]-preeop[7])*fixf);
-		*dpsi    = (preeop[8]+(nexteop[8]-preeop[8])*fixf)/(Arcs);
-		*deps    = (preeop[9]+(nexteop[9]-preeop[9])*fixf)/(Arcs);
-		*dx_pole = (preeop[10]+(nexteop[10]-preeop[10])*fixf)/(Arcs); // Pole coordinate [rad]
-		*dy_pole = (preeop[11]+(nexteop[11]-preeop[11])*fixf)/(Arcs); // Pole coordinate [rad]
-		*TAI_UTC = (preeop[12]);
+		eop->x_pole  = lerp(eopdata[4],i,fixf)/(Arcs);  // Pole coordinate [rad]
+		eop->y_pole  = lerp(eopdata[5],i,fixf)/(Arcs);  // Pole coordinate [rad]
+		eop->UT1_UTC = lerp(eopdata[6],i,fixf);
+		eop->LOD     = lerp(eopdata[7],i,fixf);
+		eop->dpsi    = lerp(eopdata[8],i,fixf)/(Arcs);
+		eop->deps    = lerp(eopdata[9],i,fixf)/(Arcs);
+		eop->dx_pole = lerp(eopdata[10],i,fixf)/(Arcs); // Pole coordinate [rad]
+		eop->dy_pole = lerp(eopdata[11],i,fixf)/(Arcs); // Pole coordinate [rad]
+		eop->TAI_UTC = eopdata[12][i];
 	}
 	else if (interp =='n') {
-		double *auxeop = v_extract(eopdata,feopdata,ceopdata,i);
-		
 		// Setting of IERS Earth rotation parameters
 		// (UT1-UTC [s], TAI-UTC [s], x ["], y ["])
-		*x_pole  = auxeop[4]/(Arcs);  // Pole coordinate [rad]
-		*y_pole  = auxeop[5]/(Arcs);  // Pole coordinate [rad]
-		*UT1_UTC = auxeop[6];             // UT1-UTC time difference [s]
-		*LOD     = auxeop[7];             // Length of day [s]
-		*dpsi    = auxeop[8]/(Arcs);
-		*deps    = auxeop[9]/(Arcs);
-		*dx_pole = auxeop[10]/(Arcs); // Pole coordinate [rad]
-		*dy_pole = auxeop[11]/(Arcs); // Pole coordinate [rad]
-		*TAI_UTC = auxeop[12];            // TAI-UTC time difference [s]
+		eop->x_pole  = eopdata[4][i]/(Arcs);  // Pole coordinate [rad]
+		eop->y_pole  = eopdata[5][i]/(Arcs);  // Pole coordinate [rad]
+		eop->UT1_UTC = eopdata[6][i];         // UT1-UTC time difference [s]
+		eop->LOD     = eopdata[7][i];         // Length of day [s]
+		eop->dpsi    = eopdata[8][i]/(Arcs);
+		eop->deps    = eopdata[9][i]/(Arcs);
+		eop->dx_pole = eopdata[10][i]/(Arcs); // Pole coordinate [rad]
+		eop->dy_pole = eopdata[11][i]/(Arcs); // Pole coordinate [rad]
+		eop->TAI_UTC = eopdata[12][i];        // TAI-UTC time difference [s]
 	}
 }
 
+void IERS(double Mjd_UTC, char interp,
+			double *x_pole, double *y_pole, double *UT1_UTC,
+			double *LOD, double *dpsi, double *deps, double *dx_pole,
+			double *dy_pole, double *TAI_UTC) {
+	EOP eop;
+	
+	IERS_eop(Mjd_UTC, interp, &eop);
+	
+	*x_pole  = eop.x_pole;
+	*y_pole  = eop.y_pole;
+	*UT1_UTC = eop.UT1_UTC;
+	*LOD     = eop.LOD;
+	*dpsi    = eop.dpsi;
+	*deps    = eop.deps;
+	*dx_pole = eop.dx_pole;
+	*dy_pole = eop.dy_pole;
+	*TAI_UTC = eop.TAI_UTC;
+}
@@ -10,22 +10,22 @@
  *  @bug No know bugs.
  */
 
-#include "../includes/m_utils.h"
+#include "../includes/m_fixed.h"
 #include "../includes/R_y.h"
 #include "../includes/R_z.h"
 
 #include <stdio.h>
 
 
-double **LTC(double lon, double lat) {
-	double **M = m_dot(R_y(-lat),3,3,R_z(lon),3,3);
+Mat3 LTC(double lon, double lat) {
+	Mat3 M = m3_dot(R_y(-lat),R_z(lon));
 
 	double Aux;
 	for(int j=0; j<3; j++) {
-		Aux = M[0][j];
-		M[0][j] = M[1][j];
-		M[1][j] = M[2][j];
-		M[2][j] = Aux;
+		Aux = M.m[0][j];
+		M.m[0][j] = M.m[1][j];
+		M.m[1][j] = M.m[2][j];
+		M.m[2][j] = Aux;
 	}
 	
 	return M;
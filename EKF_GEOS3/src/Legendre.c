@@ -8,64 +8,132 @@
  *  @bug No know bugs.
  */
 
+#include "../includes/Legendre.h"
 #include "../includes/m_utils.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 
 
 void Legendre(int n, int m, double fi, double ***pnm, double ***dpnm) {
+	LegendreEngine *le = Legendre_create(n,m);
+	
+	Legendre_eval(le,fi);
 	
 	*pnm = m_zeros(n+1,m+1);
 	*dpnm = m_zeros(n+1,m+1);
-
-	(*pnm)[0][0]=1;
-	(*dpnm)[0][0]=0;
-	(*pnm)[1][1]=sqrt(3)*cos(fi);
-	(*dpnm)[1][1]=-sqrt(3)*sin(fi);
 	
-	// diagonal coefficients
-	for(int i=2; i<=n; i++) {
-		(*pnm)[i][i]= sqrt((2.0*i+1)/(2*i))*cos(fi)*(*pnm)[i-1][i-1];
+	for(int i=0; i<=n; i++) {
+		for(int j=0; j<=m && j<=i; j++) {
+			(*pnm)[i][j] = le->pnm[LEG_NM(i,j)];
+			(*dpnm)[i][j] = le->dpnm[LEG_NM(i,j)];
+		}
 	}
-	for(int i=2; i<=n; i++) {
-		(*dpnm)[i][i]= sqrt((2.0*i+1)/(2*i))*((cos(fi)*(*dpnm)[i-1][i-1])-(sin(fi)*(*pnm)[i-1][i-1]));
+	
+	Legendre_free(le);
+}
+
+// The engine lives across calls, so it is not drawn from the bound arena
+static double *table(int size) {
+	double *t = (double *) calloc(size, sizeof(double));
+	
+	if(t == NULL) {
+		printf("Legendre: error\n");
+		exit(EXIT_FAILURE);
 	}
 	
-	// horizontal first step coefficients
-	for(int i=1; i<=n; i++) {
-		(*pnm)[i][i-1]= sqrt(2.0*i+1)*sin(fi)*(*pnm)[i-1][i-1];
+	return t;
+}
+
+LegendreEngine *Legendre_create(int n, int m) {
+	LegendreEngine *le = (LegendreEngine *) malloc(sizeof(LegendreEngine));
+	int size = LEG_NM(n,n)+1;
+	
+	if(le == NULL || n < 0 || m < 0) {
+		printf("Legendre: error\n");
+		exit(EXIT_FAILURE);
 	}
+	
+	le->n = n;
+	le->m = m;
+	le->diag = table(n+1);
+	le->sub = table(n+1);
+	le->b = table(n+1);
+	le->a = table(size);
+	le->c = table(size);
+	le->pnm = table(size);
+	le->dpnm = table(size);
+	
 	for(int i=1; i<=n; i++) {
-		(*dpnm)[i][i-1]= sqrt(2.0*i+1)*((cos(fi)*(*pnm)[i-1][i-1])+(sin(fi)*(*dpnm)[i-1][i-1]));
+		le->diag[i] = (i == 1) ? sqrt(3) : sqrt((2.0*i+1)/(2*i));
+		le->sub[i] = sqrt(2.0*i+1);
+		le->b[i] = sqrt(2.0*i-1);
 	}
 	
-	// horizontal second step coefficients
-	int j = 0;
-	int k = 2;
-	while(1) {
-		for(int i=k; i<=n; i++) {
-			(*pnm)[i][j]=sqrt((2.0*i+1)/((i-j)*(i+j)))*((sqrt(2.0*i-1)*sin(fi)*(*pnm)[i-1][j])
-				-(sqrt(((i+j-1)*(i-j-1))/(2.0*i-3))*(*pnm)[i-2][j]));
-		}
-		j = j+1;
-		k = k+1;
-		if(j>m) {
-			break;
+	for(int j=0; j<=m && j<=n; j++) {
+		for(int i=j+2; i<=n; i++) {
+			le->a[LEG_NM(i,j)] = sqrt((2.0*i+1)/((i-j)*(i+j)));
+			le->c[LEG_NM(i,j)] = sqrt(((i+j-1)*(i-j-1))/(2.0*i-3));
 		}
 	}
 	
-	j = 0;
-	k = 2;
-	while(1) {
-		for(int i=k; i<=n; i++) {
-			(*dpnm)[i][j]=sqrt((2.0*i+1)/((i-j)*(i+j)))*((sqrt(2.0*i-1)*sin(fi)*(*dpnm)[i-1][j])
-				 +(sqrt(2.0*i-1)*cos(fi)*(*pnm)[i-1][j])-(sqrt(((i+j-1)*(i-j-1))/(2.0*i-3))*(*dpnm)[i-2][j]));
-		}
-		j = j+1;
-		k = k+1;
-		if(j>m) {
-			break;
+	return le;
+}
+
+void Legendre_free(LegendreEngine *le) {
+	free(le->diag);
+	free(le->sub);
+	free(le->b);
+	free(le->a);
+	free(le->c);
+	free(le->pnm);
+	free(le->dpnm);
+	free(le);
+}
+
+void Legendre_eval(LegendreEngine *le, double fi) {
+	Legendre_eval_nm(le,fi,le->n,le->m);
+}
+
+void Legendre_eval_nm(LegendreEngine *le, double fi, int n, int m) {
+	if(n < 0 || n > le->n || m < 0 || m > le->m) {
+		printf("Legendre: error\n");
+		exit(EXIT_FAILURE);
+	}
+	m = (m < n) ? m : n;
+	double *p = le->pnm, *dp = le->dpnm;
+	double cf = cos(fi), sf = sin(fi);
+	
+	p[0] = 1;
+	dp[0] = 0;
+	if(n < 1) {
+		return;
+	}
+	p[LEG_NM(1,1)] = le->diag[1]*cf;
+	dp[LEG_NM(1,1)] = -le->diag[1]*sf;
+	
+	// diagonal coefficients
+	for(int i=2; i<=m; i++) {
+		p[LEG_NM(i,i)] = le->diag[i]*cf*p[LEG_NM(i-1,i-1)];
+		dp[LEG_NM(i,i)] = le->diag[i]*((cf*dp[LEG_NM(i-1,i-1)])-(sf*p[LEG_NM(i-1,i-1)]));
+	}
+	
+	// horizontal first step coefficients
+	for(int i=1; i<=n && i<=m+1; i++) {
+		p[LEG_NM(i,i-1)] = le->sub[i]*sf*p[LEG_NM(i-1,i-1)];
+		dp[LEG_NM(i,i-1)] = le->sub[i]*((cf*p[LEG_NM(i-1,i-1)])+(sf*dp[LEG_NM(i-1,i-1)]));
+	}
+	
+	// horizontal second step coefficients
+	for(int j=0; j<=m; j++) {
+		for(int i=j+2; i<=n; i++) {
+			int k = LEG_NM(i,j);
+			double bs = le->b[i]*sf;
+			
+			p[k] = le->a[k]*((bs*p[LEG_NM(i-1,j)])-(le->c[k]*p[LEG_NM(i-2,j)]));
+			dp[k] = le->a[k]*((bs*dp[LEG_NM(i-1,j)])
+				+(le->b[i]*cf*p[LEG_NM(i-1,j)])-(le->c[k]*dp[LEG_NM(i-2,j)]));
 		}
 	}
 }
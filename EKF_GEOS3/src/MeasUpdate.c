@@ -13,26 +13,33 @@
 #include <stdio.h>
 
 
-void MeasUpdate(double z, double g, double s, double *G, double **K, double **x, double ***P) {
-	double **Inv_W = m_zeros(1,1);
+void MeasUpdate(double z, double g, double s, double *G, double *K, double *x, double **P) {
+	double GP[6], PG[6];
+	double eye_data[36], *eye[6], P_old_data[36], *P_old[6];
+	m_wrap(eye_data,eye,6,6);
+	m_wrap(P_old_data,P_old,6,6);
 
-	Inv_W[0][0] = s*s;    // Inverse weight (measurement covariance)
+	double Inv_W = s*s;    // Inverse weight (measurement covariance)
 	
 	// Kalman gain
-	double aux = v_dot(v_dot_m(G,6,*P,6,6),6,G,6);
-	Inv_W[0][0] += aux;
-	*K = v_mul_scalar(m_dot_v(*P,6,6,G,6),6,m_inv(Inv_W,1)[0][0]);
+	v_dot_m_into(G,6,P,6,6,GP);
+	Inv_W += v_dot(GP,6,G,6);
+	m_dot_v_into(P,6,6,G,6,PG);
+	for(int i=0; i<6; i++) {
+		K[i] = PG[i]*(1.0/Inv_W);
+	}
 
 	// State update
-	*x = v_sum(*x,6,v_mul_scalar(*K,6,(z-g)),6);
+	v_axpy(z-g,K,6,x,6);
 	
 	// Covariance update
-	double **eye = m_eye(6);
 	for(int i=0; i<6; i++) {
 		for(int j=0; j<6; j++) {
-			eye[i][j] -= (*K)[i]*G[j];
+			eye[i][j] = (i==j) ? 1.0 : 0.0;
+			eye[i][j] -= K[i]*G[j];
+			P_old[i][j] = P[i][j];
 		}
 	}
-	*P = m_dot(eye,6,6,*P,6,6);
+	m_dot_into(eye,6,6,P_old,6,6,P);
 }
 
@@ -10,7 +10,7 @@
 
 #include "../includes/MeanObliquity.h"
 #include "../includes/NutAngles.h"
-#include "../includes/m_utils.h"
+#include "../includes/m_fixed.h"
 #include "../includes/R_x.h"
 #include "../includes/R_z.h"
 
@@ -20,7 +20,7 @@
 #include <math.h>
 
 
-double **NutMatrix(double Mjd_TT) {
+Mat3 NutMatrix(double Mjd_TT) {
 	// Mean obliquity of the ecliptic
 	double eps = MeanObliquity(Mjd_TT);
 
@@ -29,5 +29,5 @@ double **NutMatrix(double Mjd_TT) {
 	NutAngles(Mjd_TT, &dpsi, &deps);
 
 	// Transformation from mean to true equator and equinox
-	 return m_dot(m_dot(R_x(-eps-deps),3,3,R_z(-dpsi),3,3),3,3,R_x(eps),3,3);
+	 return m3_dot(m3_dot(R_x(-eps-deps),R_z(-dpsi)),R_x(eps));
 }
@@ -8,7 +8,7 @@
  *  @bug No know bugs.
  */
 
-#include "../includes/m_utils.h"
+#include "../includes/m_fixed.h"
 #include "../includes/R_x.h"
 #include "../includes/R_y.h"
 
@@ -17,6 +17,6 @@
 #include <math.h>
 
 
-double **PoleMatrix(double xp, double yp) {
-	return m_dot(R_y(-xp),3,3,R_x(-yp),3,3);
+Mat3 PoleMatrix(double xp, double yp) {
+	return m3_dot(R_y(-xp),R_x(-yp));
 }
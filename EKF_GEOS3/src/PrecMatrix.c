@@ -9,7 +9,7 @@
  */
 
 #include "../includes/const.h"
-#include "../includes/m_utils.h"
+#include "../includes/m_fixed.h"
 #include "../includes/R_y.h"
 #include "../includes/R_z.h"
 
@@ -17,7 +17,7 @@
 #include <stdlib.h>
 
 
-double **PrecMatrix(double Mjd_1, double Mjd_2) {
+Mat3 PrecMatrix(double Mjd_1, double Mjd_2) {
 	double T  = (Mjd_1-(MJD_J2000))/36525.0;
 	double dT = (Mjd_2-Mjd_1)/36525.0;
 
@@ -29,6 +29,6 @@ double **PrecMatrix(double Mjd_1, double Mjd_2) {
 				  ((0.42665+0.000217*T)+0.041833*dT)*dT)*dT/(Arcs);
 
 	// Precession matrix
-	return m_dot(m_dot(R_z(-z),3,3,R_y(theta),3,3),3,3,R_z(-zeta),3,3);
+	return m3_dot(m3_dot(R_z(-z),R_y(theta)),R_z(-zeta));
 }
 
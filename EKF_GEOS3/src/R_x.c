@@ -7,23 +7,23 @@
  *  @bug No know bugs.
  */
 
-#include "../includes/m_utils.h"
+#include "../includes/m_fixed.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 
 
-double **R_x(double angle) {
-	double C, S, **rotmat;
+Mat3 R_x(double angle) {
+	double C, S;
+	Mat3 rotmat;
 	
 	C = cos(angle);
 	S = sin(angle);
-	rotmat = m_create(3,3);
 	
-	rotmat[0][0] = 1.0;  rotmat[0][1] =    0.0;  rotmat[0][2] = 0.0;
-	rotmat[1][0] = 0.0;  rotmat[1][1] =      C;  rotmat[1][2] =   S;
-	rotmat[2][0] = 0.0;  rotmat[2][1] = -1.0*S;  rotmat[2][2] =   C;
+	rotmat.m[0][0] = 1.0;  rotmat.m[0][1] =    0.0;  rotmat.m[0][2] = 0.0;
+	rotmat.m[1][0] = 0.0;  rotmat.m[1][1] =      C;  rotmat.m[1][2] =   S;
+	rotmat.m[2][0] = 0.0;  rotmat.m[2][1] = -1.0*S;  rotmat.m[2][2] =   C;
 	
 	return rotmat;
 }
@@ -13,7 +13,12 @@
 #include <stdio.h>
 
 
-double **TimeUpdate(double **P, double **Phi, double **Qdt) {
-	return m_sum(m_dot(Phi,6,6,m_dot(P,6,6,m_trans(Phi,6),6,6),6,6),6,6,Qdt,6,6);
+void TimeUpdate(double **P, double **Phi, double **Qdt) {
+	double aux_data[36], *aux[6];
+	m_wrap(aux_data,aux,6,6);
+
+	m_dot_trans_into(P,6,6,Phi,6,6,aux);
+	m_dot_into(Phi,6,6,aux,6,6,P);
+	m_sum_into(P,6,6,Qdt,6,6,P);
 }
 
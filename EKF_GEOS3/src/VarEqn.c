@@ -12,84 +12,93 @@
 #include "../includes/const.h"
 #include "../includes/IERS.h"
 #include "../includes/timediff.h"
-#include "../includes/PrecMatrix.h"
-#include "../includes/NutMatrix.h"
 #include "../includes/m_utils.h"
+#include "../includes/m_fixed.h"
 #include "../includes/PoleMatrix.h"
-#include "../includes/GHAMatrix.h"
+#include "../includes/EarthRot.h"
+#include "../includes/Cunningham.h"
 #include "../includes/AccelHarmonic.h"
-#include "../includes/G_AccelHarmonic.h"
+#include "../includes/Accel.h"
 
 #include <stdio.h>
 #include <math.h>
 
 
-void VarEqn(double x, double *yPhi, double **yPhip) {
-	extern Param AuxParam;
-	
-	double x_pole, y_pole, UT1_UTC, LOD, dpsi, deps, dx_pole, dy_pole, TAI_UTC;
-	IERS(AuxParam.Mjd_UTC,'l',&x_pole,&y_pole,&UT1_UTC,&LOD,&dpsi,&deps,&dx_pole,&dy_pole,&TAI_UTC);
-	
-	double UT1_TAI, UTC_GPS, UT1_GPS, TT_UTC, GPS_UTC;
-	timediff(UT1_UTC,TAI_UTC,&UT1_TAI,&UTC_GPS,&UT1_GPS,&TT_UTC,&GPS_UTC);
-	
-	double Mjd_UT1 = AuxParam.Mjd_TT + (UT1_UTC-TT_UTC)/86400;
-	
-	// Transformation matrix
-	double **P = PrecMatrix((MJD_J2000),AuxParam.Mjd_TT + x/86400.0);
-	double **N = NutMatrix(AuxParam.Mjd_TT + x/86400.0);
-	double **T = m_dot(N,3,3,P,3,3);
-	double **E = m_dot(m_dot(PoleMatrix(x_pole,y_pole),3,3,GHAMatrix(Mjd_UT1),3,3),3,3,T,3,3);
-	
-	// State vector components
-	double *r = v_create(3);
-	double *v = v_create(3);
-	for(int i=0; i<3; i++) {
-		r[i] = yPhi[i];
-		v[i] = yPhi[i+3];
-	}
-	double **Phi = m_zeros(6,6);
+// Derivative of yPhi from the acceleration a and the gradient G
+static void derivative(const double *yPhi, Vec3 a, Mat3 G, double **yPhip) {
+	Vec3 v = v3_load(&yPhi[3]);
+	Mat6 Phi;
 
 	// State transition matrix
 	for(int j=0; j<6; j++) {
 		for(int i=0; i<6; i++) {
-			Phi[i][j] = yPhi[6*(j+1)+i];
+			Phi.m[i][j] = yPhi[6*(j+1)+i];
 		}
 	}
 	
-	// Acceleration and gradient
-	double *a = AccelHarmonic(r, E, AuxParam.n, AuxParam.m);
-	double **G = G_AccelHarmonic(r, E, AuxParam.n, AuxParam.m);
-	
 	// Time derivative of state transition matrix
 	*yPhip = v_create(42);
-	double **dfdy = m_zeros(6,6);
+	Mat6 dfdy;
 
 	for(int i=0; i<3; i++) {
 		for(int j=0; j<3; j++) {
-			dfdy[i][j] = 0.0;                 // dv/dr(i,j)
-			dfdy[i+3][j] = G[i][j];           // da/dr(i,j)
+			dfdy.m[i][j] = 0.0;                 // dv/dr(i,j)
+			dfdy.m[i+3][j] = G.m[i][j];         // da/dr(i,j)
 			if(i==j) {
-				dfdy[i][j+3] = 1;
+				dfdy.m[i][j+3] = 1;
 			}
 			else {
-				dfdy[i][j+3] = 0;             // dv/dv(i,j)
+				dfdy.m[i][j+3] = 0;             // dv/dv(i,j)
 			}
-			dfdy[i+3][j+3] = 0.0;             // da/dv(i,j)
+			dfdy.m[i+3][j+3] = 0.0;             // da/dv(i,j)
 		}
 	}
 
-	double **Phip = m_dot(dfdy,6,6,Phi,6,6);
+	Mat6 Phip = m6_dot(dfdy,Phi);
 	// Derivative of combined state vector and state transition matrix
 	for(int i=0; i<3; i++) {
-		(*yPhip)[i]   = v[i];                 // dr/dt(i)
-		(*yPhip)[i+3] = a[i];                 // dv/dt(i)
+		(*yPhip)[i]   = v.v[i];               // dr/dt(i)
+		(*yPhip)[i+3] = a.v[i];               // dv/dt(i)
 	}
 
 	for(int i=0; i<6; i++) {
 		for(int j=0; j<6; j++) {
-			(*yPhip)[6*(j+1)+i] = Phip[i][j];     // dPhi/dt(i,j)
+			(*yPhip)[6*(j+1)+i] = Phip.m[i][j];   // dPhi/dt(i,j)
 		}
 	}
 }
 
+void VarEqn(double x, double *yPhi, double **yPhip) {
+	extern Param AuxParam;
+	
+	// Epoch of x, as in Accel, so that one integration can run over
+	// several output points
+	EOP eop;
+	IERS_eop(AuxParam.Mjd_UTC + x/86400.0,'l',&eop);
+	
+	double UT1_TAI, UTC_GPS, UT1_GPS, TT_UTC, GPS_UTC;
+	timediff(eop.UT1_UTC,eop.TAI_UTC,&UT1_TAI,&UTC_GPS,&UT1_GPS,&TT_UTC,&GPS_UTC);
+	
+	double Mjd_UT1 = AuxParam.Mjd_UTC + x/86400.0 + eop.UT1_UTC/86400.0;
+	double Mjd_TT = AuxParam.Mjd_UTC + x/86400.0 + TT_UTC/86400.0;
+	
+	// Transformation matrix
+	EarthRot *er = EarthRot_current();
+	Mat3 T = EarthRot_NP(er,Mjd_TT);
+	Mat3 E = m3_dot(m3_dot(PoleMatrix(eop.x_pole,eop.y_pole),EarthRot_GHA(er,Mjd_UT1)),T);
+	
+	// Acceleration and gradient, from one recursion
+	Mat3 G;
+	Vec3 a = Cunningham(v3_load(&yPhi[0]), E, AuxParam.n, AuxParam.m, &G);
+	AccelHarmonic_count(AuxParam.n, 1);
+	
+	derivative(yPhi, a, G, yPhip);
+}
+
+void VarEqn_full(double x, double *yPhi, double **yPhip) {
+	Mat3 G;
+	Vec3 a = Accel_gradient(x, v3_load(&yPhi[0]), &G);
+	
+	derivative(yPhi, a, G, yPhip);
+}
+
@@ -10,14 +10,13 @@
 
 #include "../includes/const.h"
 #include "../includes/m_utils.h"
+#include "../includes/m_fixed.h"
 #include "../includes/Geodetic.h"
 #include "../includes/LTC.h"
 #include "../includes/IERS.h"
 #include "../includes/timediff.h"
-#include "../includes/PrecMatrix.h"
-#include "../includes/NutMatrix.h"
 #include "../includes/PoleMatrix.h"
-#include "../includes/GHAMatrix.h"
+#include "../includes/EarthRot.h"
 #include "../includes/rpoly.h"
 #include "../includes/gibbs.h"
 #include "../includes/hgibbs.h"
@@ -54,14 +53,14 @@ void anglesg(double az1, double az2, double az3, double el1,
 	//double lon3, lat3, h3;
 	//Geodetic(Rs3, &lon3, &lat3, &h3);
 
-	double **M1 = LTC(lon1, lat1);
-	//double **M2 = LTC(lon2, lat2);
-	//double **M3 = LTC(lon3, lat3);
+	Mat3 M1 = LTC(lon1, lat1);
+	//Mat3 M2 = LTC(lon2, lat2);
+	//Mat3 M3 = LTC(lon3, lat3);
 
 	// body-fixed system
-	double *Lb1 = m_dot_v(m_trans(M1,3),3,3,L1,3);
-	double *Lb2 = m_dot_v(m_trans(M1,3),3,3,L2,3);
-	double *Lb3 = m_dot_v(m_trans(M1,3),3,3,L3,3);
+	Vec3 Lb1 = m3_trans_dot_v3(M1,v3_load(L1));
+	Vec3 Lb2 = m3_trans_dot_v3(M1,v3_load(L2));
+	Vec3 Lb3 = m3_trans_dot_v3(M1,v3_load(L3));
 
 	// mean of date system (J2000)
 	double Mjd_UTC = Mjd1;
@@ -75,13 +74,15 @@ void anglesg(double az1, double az2, double az3, double el1,
 	double Mjd_TT = Mjd_UTC + TT_UTC/86400.0;
 	double Mjd_UT1 = Mjd_TT + (UT1_UTC-TT_UTC)/86400.0;
 
-	double **P = PrecMatrix((MJD_J2000),Mjd_TT);
-	double **N = NutMatrix(Mjd_TT);
-	double **T = m_dot(N,3,3,P,3,3);
-	double **E = m_dot(m_dot(PoleMatrix(x_pole,y_pole),3,3,GHAMatrix(Mjd_UT1),3,3),3,3,T,3,3);
+	EarthRot *er = EarthRot_current();
+	Mat3 T = EarthRot_NP(er,Mjd_TT);
+	Mat3 E = m3_dot(m3_dot(PoleMatrix(x_pole,y_pole),EarthRot_GHA(er,Mjd_UT1)),T);
 
-	double *Lm1 = m_dot_v(m_trans(E,3),3,3,Lb1,3);
-	Rs1 = m_dot_v(m_trans(E,3),3,3,Rs1,3);
+	double *Lm1 = v_create(3);
+	v3_store(m3_trans_dot_v3(E,Lb1),Lm1);
+	double *Rs1_aux = v_create(3);
+	v3_store(m3_trans_dot_v3(E,v3_load(Rs1)),Rs1_aux);
+	Rs1 = Rs1_aux;
 
 	Mjd_UTC = Mjd2;
 	IERS(Mjd_UTC,'l',&x_pole,&y_pole,&UT1_UTC,&LOD,&dpsi,&deps,&dx_pole,&dy_pole,&TAI_UTC);
@@ -89,13 +90,14 @@ void anglesg(double az1, double az2, double az3, double el1,
 	Mjd_TT = Mjd_UTC + TT_UTC/86400.0;
 	Mjd_UT1 = Mjd_TT + (UT1_UTC-TT_UTC)/86400.0;
 
-	P = PrecMatrix((MJD_J2000),Mjd_TT);
-	N = NutMatrix(Mjd_TT);
-	T = m_dot(N,3,3,P,3,3);
-	E = m_dot(m_dot(PoleMatrix(x_pole,y_pole),3,3,GHAMatrix(Mjd_UT1),3,3),3,3,T,3,3);
+	T = EarthRot_NP(er,Mjd_TT);
+	E = m3_dot(m3_dot(PoleMatrix(x_pole,y_pole),EarthRot_GHA(er,Mjd_UT1)),T);
 
-	double *Lm2 = m_dot_v(m_trans(E,3),3,3,Lb2,3);
-	Rs2 = m_dot_v(m_trans(E,3),3,3,Rs2,3);
+	double *Lm2 = v_create(3);
+	v3_store(m3_trans_dot_v3(E,Lb2),Lm2);
+	double *Rs2_aux = v_create(3);
+	v3_store(m3_trans_dot_v3(E,v3_load(Rs2)),Rs2_aux);
+	Rs2 = Rs2_aux;
 
 	Mjd_UTC = Mjd3;
 	IERS(Mjd_UTC,'l',&x_pole,&y_pole,&UT1_UTC,&LOD,&dpsi,&deps,&dx_pole,&dy_pole,&TAI_UTC);
@@ -103,13 +105,14 @@ void anglesg(double az1, double az2, double az3, double el1,
 	Mjd_TT = Mjd_UTC + TT_UTC/86400.0;
 	Mjd_UT1 = Mjd_TT + (UT1_UTC-TT_UTC)/86400.0;
 
-	P = PrecMatrix((MJD_J2000),Mjd_TT);
-	N = NutMatrix(Mjd_TT);
-	T = m_dot(N,3,3,P,3,3);
-	E = m_dot(m_dot(PoleMatrix(x_pole,y_pole),3,3,GHAMatrix(Mjd_UT1),3,3),3,3,T,3,3);
+	T = EarthRot_NP(er,Mjd_TT);
+	E = m3_dot(m3_dot(PoleMatrix(x_pole,y_pole),EarthRot_GHA(er,Mjd_UT1)),T);
 
-	double *Lm3 = m_dot_v(m_trans(E,3),3,3,Lb3,3);
-	Rs3 = m_dot_v(m_trans(E,3),3,3,Rs3,3);
+	double *Lm3 = v_create(3);
+	v3_store(m3_trans_dot_v3(E,Lb3),Lm3);
+	double *Rs3_aux = v_create(3);
+	v3_store(m3_trans_dot_v3(E,v3_load(Rs3)),Rs3_aux);
+	Rs3 = Rs3_aux;
 
 	// geocentric inertial position
 	double tau1 = (Mjd1-Mjd2)*86400.0;
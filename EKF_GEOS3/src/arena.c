@@ -0,0 +1,107 @@
+/** @file arena.c
+ *  @brief Arena allocator code driver.
+ *
+ *  This driver contains the code for the bump-pointer
+ *  arena allocator.
+ *
+ *  @author Miguel Alonso Angulo.
+ *  @bug No know bugs.
+ */
+
+#include "../includes/arena.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_ALIGN 16
+
+
+static Arena *bound = NULL;
+
+Arena *arena_create(size_t size) {
+	Arena *a = (Arena *) malloc(sizeof(Arena));
+	
+	if (a == NULL) {
+		printf("arena create: error\n");
+		exit(EXIT_FAILURE);
+	}
+	
+	a->base = (char *) malloc(size);
+	if (a->base == NULL) {
+		printf("arena create: error\n");
+		exit(EXIT_FAILURE);
+	}
+	
+	a->size = size;
+	a->used = 0;
+	a->peak = 0;
+	
+	return a;
+}
+
+void arena_free(Arena *a) {
+	if (bound == a) {
+		bound = NULL;
+	}
+	
+	free(a->base);
+	free(a);
+}
+
+void *arena_alloc(Arena *a, size_t bytes) {
+	size_t start = (a->used + ARENA_ALIGN - 1) & ~((size_t) ARENA_ALIGN - 1);
+	
+	if (start + bytes > a->size) {
+		printf("arena alloc: error (%zu of %zu bytes)\n", start + bytes, a->size);
+		exit(EXIT_FAILURE);
+	}
+	
+	a->used = start + bytes;
+	if (a->used > a->peak) {
+		a->peak = a->used;
+	}
+	
+	memset(a->base + start, 0, bytes);
+	
+	return a->base + start;
+}
+
+size_t arena_mark(Arena *a) {
+	return a->used;
+}
+
+void arena_release(Arena *a, size_t mark) {
+	if (mark > a->used) {
+		printf("arena release: error\n");
+		exit(EXIT_FAILURE);
+	}
+	
+	a->used = mark;
+}
+
+void arena_reset(Arena *a) {
+	a->used = 0;
+}
+
+size_t arena_peak(Arena *a) {
+	return a->peak;
+}
+
+int arena_owns(Arena *a, void *p) {
+	char *c = (char *) p;
+	
+	return a != NULL && c >= a->base && c < a->base + a->size;
+}
+
+Arena *arena_bind(Arena *a) {
+	Arena *old = bound;
+	
+	bound = a;
+	
+	return old;
+}
+
+Arena *arena_current(void) {
+	return bound;
+}
@@ -8,23 +8,161 @@
  *  @bug No know bugs.
  */
 
+#include "../includes/global.h"
 #include "../includes/m_utils.h"
 #include "../includes/Mjday.h"
 #include "../includes/const.h"
+#include "../includes/GravModel.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 
+// The binary cache is mapped where mmap exists, and read in elsewhere
+// (MinGW)
+#if defined(__unix__) || defined(__APPLE__)
+#define DE430_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#define DE430_TXT "data/DE430Coeff.txt"
+#define DE430_BIN "data/DE430Coeff.bin"
+#define DE430_MAGIC "DE430BIN"
+
+
+#ifdef DE430_MMAP
+// Map the binary cache and point the rows of PC into it. Returns 0 if
+// there is no usable cache.
+static int DE430Map(int f, int c) {
+	extern double **PC;
+	struct stat sb, st;
+	size_t size = sizeof(DE430Header) + (size_t) f*c*sizeof(double);
+	
+	int fd = open(DE430_BIN, O_RDONLY);
+	if(fd < 0) {
+		return 0;
+	}
+	
+	if(fstat(fd,&sb) != 0 || (size_t) sb.st_size != size ||
+	   (stat(DE430_TXT,&st) == 0 && st.st_mtime > sb.st_mtime)) {
+		close(fd);
+		return 0;
+	}
+	
+	void *map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(map == MAP_FAILED) {
+		return 0;
+	}
+	
+	DE430Header *h = (DE430Header *) map;
+	if(memcmp(h->magic, DE430_MAGIC, 8) != 0 || h->records != f || h->coeffs != c) {
+		munmap(map, size);
+		return 0;
+	}
+	
+	PC = (double **) malloc(f*sizeof(double *));
+	if(PC == NULL) {
+		printf("DE430Coeff: error\n");
+		exit(EXIT_FAILURE);
+	}
+	m_wrap((double *) (h + 1), PC, f, c);
+	
+	return 1;
+}
+#else
+// Read the binary cache into PC. Returns 0 if there is no usable cache.
+static int DE430Map(int f, int c) {
+	extern double **PC;
+	struct stat sb, st;
+	DE430Header h;
+	size_t size = sizeof(DE430Header) + (size_t) f*c*sizeof(double);
+	
+	if(stat(DE430_BIN,&sb) != 0 || (size_t) sb.st_size != size ||
+	   (stat(DE430_TXT,&st) == 0 && st.st_mtime > sb.st_mtime)) {
+		return 0;
+	}
+	
+	FILE *fp = fopen(DE430_BIN,"rb");
+	if(fp == NULL) {
+		return 0;
+	}
+	
+	if(fread(&h, sizeof(h), 1, fp) != 1 || memcmp(h.magic, DE430_MAGIC, 8) != 0 ||
+	   h.records != f || h.coeffs != c) {
+		fclose(fp);
+		return 0;
+	}
+	
+	// m_create storage is contiguous, PC[0] is the whole table
+	PC = m_create(f,c);
+	if(fread(PC[0], sizeof(double), (size_t) f*c, fp) != (size_t) f*c) {
+		m_free(PC,f,c);
+		fclose(fp);
+		return 0;
+	}
+	
+	fclose(fp);
+	
+	return 1;
+}
+#endif
+
+// Write the binary cache. It goes through a temporary file renamed at
+// the end, so other processes never map a partial cache. Failures are
+// not fatal: the next run parses the text file again.
+static void DE430Store(int f, int c) {
+	extern double **PC;
+	char tmp[64];
+	DE430Header h;
+	
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, DE430_MAGIC, 8);
+	h.records = f;
+	h.coeffs = c;
+	h.jd_first = PC[0][0];
+	h.jd_last = PC[f-1][1];
+	
+#ifdef DE430_MMAP
+	snprintf(tmp, sizeof(tmp), "%s.%d", DE430_BIN, (int) getpid());
+#else
+	snprintf(tmp, sizeof(tmp), "%s.tmp", DE430_BIN);
+#endif
+	FILE *fp = fopen(tmp,"wb");
+	if(fp == NULL) {
+		return;
+	}
+	
+	// m_create storage is contiguous, PC[0] is the whole table
+	int ok = fwrite(&h, sizeof(h), 1, fp) == 1 &&
+			 fwrite(PC[0], sizeof(double), (size_t) f*c, fp) == (size_t) f*c;
+	ok = (fclose(fp) == 0) && ok;
+	
+#ifndef DE430_MMAP
+	// rename does not replace an existing file there
+	remove(DE430_BIN);
+#endif
+	if(!ok || rename(tmp, DE430_BIN) != 0) {
+		remove(tmp);
+	}
+}
 
 void DE430Coeff(int f, int c) {
 	extern double **PC;
 	extern int fPC, cPC;
-	PC = m_create(f,c);
 	fPC = f; //2285
 	cPC = c; //1020
 	
-	FILE *fp = fopen("data/DE430Coeff.txt","r");
+	if(DE430Map(f,c)) {
+		return;
+	}
+	
+	PC = m_create(f,c);
+	
+	FILE *fp = fopen(DE430_TXT,"r");
 	if(fp == NULL) {
 		printf("Fail open DE430Coeff.txt file\n");
 		exit(EXIT_FAILURE);
@@ -37,34 +175,16 @@ void DE430Coeff(int f, int c) {
 	}
 	
 	fclose(fp);
+	
+	DE430Store(f,c);
 }
 
 void GGM03S(int n) {
-	extern double **Cnm, **Snm;
-	extern int fCnm, cCnm, fSnm, cSnm;
-	Cnm = m_zeros(n,n);
-	Snm = m_zeros(n,n);
-	fCnm = n; //181
-	cCnm = n; //181
-	fSnm = n; //181
-	cSnm = n; //181
-	
-	double aux1, aux2;
-	int f, c;
-	
-	FILE *fp = fopen("data/GGM03S.txt","r");
-	if(fp == NULL) {
-		printf("Fail open GGM03S.txt file\n");
-		exit(EXIT_FAILURE);
-	}
+	GravModel *old = GravModel_bind(GravModel_load("data/GGM03S.txt", n-1));
 	
-	for(int i=0; i<n; i++) {
-		for(int j=0; j<=i; j++) {
-			fscanf(fp,"%d%d%lf%lf%lf%lf",&f,&c,&Cnm[i][j],&Snm[i][j],&aux1,&aux2);
-		}
+	if(old != NULL) {
+		GravModel_free(old);
 	}
-	
-	fclose(fp);
 }
 
 void eop19620101(int c) {
@@ -0,0 +1,165 @@
+/** @file m_fixed.c
+ *  @brief Fixed-size vector and matrix utilities code driver.
+ *
+ *  This driver contains the code for the fixed-size (3-vector,
+ *  3x3 and 6x6 matrix) utilities.
+ *
+ *  @author Miguel Alonso Angulo.
+ *  @bug No know bugs.
+ */
+
+#include "../includes/m_fixed.h"
+
+#include <stdio.h>
+#include <math.h>
+
+
+Vec3 v3_load(const double *v) {
+	Vec3 r;
+
+	r.v[0] = v[0];
+	r.v[1] = v[1];
+	r.v[2] = v[2];
+
+	return r;
+}
+
+void v3_store(Vec3 a, double *v) {
+	v[0] = a.v[0];
+	v[1] = a.v[1];
+	v[2] = a.v[2];
+}
+
+Vec3 v3_sum(Vec3 a, Vec3 b) {
+	Vec3 r;
+
+	for(int i = 0; i < 3; i++)
+		r.v[i] = a.v[i]+b.v[i];
+
+	return r;
+}
+
+Vec3 v3_sub(Vec3 a, Vec3 b) {
+	Vec3 r;
+
+	for(int i = 0; i < 3; i++)
+		r.v[i] = a.v[i]-b.v[i];
+
+	return r;
+}
+
+Vec3 v3_mul_scalar(Vec3 a, double s) {
+	Vec3 r;
+
+	for(int i = 0; i < 3; i++)
+		r.v[i] = a.v[i]*s;
+
+	return r;
+}
+
+double v3_norm(Vec3 a) {
+	return sqrt(a.v[0]*a.v[0] + a.v[1]*a.v[1] + a.v[2]*a.v[2]);
+}
+
+double v3_dot(Vec3 a, Vec3 b) {
+	return a.v[0]*b.v[0] + a.v[1]*b.v[1] + a.v[2]*b.v[2];
+}
+
+Vec3 v3_cross(Vec3 a, Vec3 b) {
+	Vec3 r;
+
+	r.v[0] = a.v[1]*b.v[2] - a.v[2]*b.v[1];
+	r.v[1] = a.v[2]*b.v[0] - a.v[0]*b.v[2];
+	r.v[2] = a.v[0]*b.v[1] - a.v[1]*b.v[0];
+
+	return r;
+}
+
+Vec3 v3_dot_m3(Vec3 a, Mat3 A) {
+	Vec3 r;
+
+	for(int j = 0; j < 3; j++)
+		r.v[j] = a.v[0]*A.m[0][j] + a.v[1]*A.m[1][j] + a.v[2]*A.m[2][j];
+
+	return r;
+}
+
+
+Mat3 m3_eye(void) {
+	Mat3 L;
+
+	for(int i = 0; i < 3; i++)
+		for(int j = 0; j < 3; j++)
+			L.m[i][j] = (i == j) ? 1.0 : 0.0;
+
+	return L;
+}
+
+Mat3 m3_dot(Mat3 A, Mat3 B) {
+	Mat3 L;
+
+	for(int i = 0; i < 3; i++)
+		for(int j = 0; j < 3; j++)
+			L.m[i][j] = A.m[i][0]*B.m[0][j] + A.m[i][1]*B.m[1][j] + A.m[i][2]*B.m[2][j];
+
+	return L;
+}
+
+Vec3 m3_dot_v3(Mat3 A, Vec3 a) {
+	Vec3 r;
+
+	for(int i = 0; i < 3; i++)
+		r.v[i] = A.m[i][0]*a.v[0] + A.m[i][1]*a.v[1] + A.m[i][2]*a.v[2];
+
+	return r;
+}
+
+Vec3 m3_trans_dot_v3(Mat3 A, Vec3 a) {
+	Vec3 r;
+
+	for(int i = 0; i < 3; i++)
+		r.v[i] = A.m[0][i]*a.v[0] + A.m[1][i]*a.v[1] + A.m[2][i]*a.v[2];
+
+	return r;
+}
+
+Mat3 m3_trans(Mat3 A) {
+	Mat3 L;
+
+	for(int i = 0; i < 3; i++)
+		for(int j = 0; j < 3; j++)
+			L.m[j][i] = A.m[i][j];
+
+	return L;
+}
+
+
+Mat6 m6_zeros(void) {
+	Mat6 L;
+
+	for(int i = 0; i < 6; i++)
+		for(int j = 0; j < 6; j++)
+			L.m[i][j] = 0.0;
+
+	return L;
+}
+
+Mat6 m6_eye(void) {
+	Mat6 L = m6_zeros();
+
+	for(int i = 0; i < 6; i++)
+		L.m[i][i] = 1.0;
+
+	return L;
+}
+
+Mat6 m6_dot(Mat6 A, Mat6 B) {
+	Mat6 L = m6_zeros();
+
+	for(int i = 0; i < 6; i++)
+		for(int k = 0; k < 6; k++)
+			for(int j = 0; j < 6; j++)
+				L.m[i][j] += A.m[i][k]*B.m[k][j];
+
+	return L;
+}
@@ -8,12 +8,177 @@
  *  @bug No know bugs.
  */
 
+#define M_UTILS_SOURCE
+#include "../includes/m_utils.h"
+#include "../includes/arena.h"
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
-double *v_create(int c) {
-	double *v = (double*)calloc(c, sizeof(double));
+#ifdef MEM_STATS
+
+#define MEM_HEAD 16     // Accounting header in front of every block (keeps alignment)
+#define MEM_SITES 128
+
+typedef struct {
+	int site;
+	size_t bytes;
+} MemHead;
+
+typedef struct {
+	const char *name;
+	long allocs, frees, live;
+	size_t bytes, live_bytes;
+} MemSite;
+
+static MemSite sites[MEM_SITES];
+static int nsites = 0;
+
+static int mem_lookup(const char *name) {
+	if (name == NULL) {
+		name = "(unknown)";
+	}
+	
+	for(int i = 0; i < nsites; i++) {
+		if (sites[i].name == name || strcmp(sites[i].name, name) == 0) {
+			return i;
+		}
+	}
+	
+	if (nsites == MEM_SITES) {
+		printf("memory stats: error\n");
+		exit(EXIT_FAILURE);
+	}
+	
+	if (nsites == 0) {
+		atexit(mem_report);
+	}
+	
+	memset(&sites[nsites], 0, sizeof(MemSite));
+	sites[nsites].name = name;
+	
+	return nsites++;
+}
+
+#endif
+
+// Common storage of vectors and matrices: the bound arena, if any,
+// or the heap. The allocation is recorded against the function site.
+static void *mem_get(const char *site, size_t bytes, int zero) {
+	Arena *a = arena_current();
+	char *p;
+	
+#ifdef MEM_STATS
+	bytes += MEM_HEAD;
+#else
+	(void) site;
+#endif
+	if (a != NULL) {
+		p = (char *) arena_alloc(a, bytes);
+	} else if (zero) {
+		p = (char *) calloc(1, bytes);
+	} else {
+		p = (char *) malloc(bytes);
+	}
+	
+	if (p == NULL) {
+		return NULL;
+	}
+	
+#ifdef MEM_STATS
+	MemHead *h = (MemHead *) p;
+	MemSite *s;
+	
+	h->site = mem_lookup(site);
+	h->bytes = bytes - MEM_HEAD;
+	s = &sites[h->site];
+	s->allocs++;
+	s->bytes += h->bytes;
+	// Arena blocks are reclaimed by the arena, so they never count as live
+	if (a == NULL) {
+		s->live++;
+		s->live_bytes += h->bytes;
+	}
+	p += MEM_HEAD;
+#endif
+	
+	return p;
+}
+
+static void mem_put(void *p) {
+	// Arena storage is released by the arena itself
+	if (p == NULL || arena_owns(arena_current(), p)) {
+		return;
+	}
+	
+#ifdef MEM_STATS
+	MemHead *h = (MemHead *) ((char *) p - MEM_HEAD);
+	MemSite *s = &sites[h->site];
+	
+	s->frees++;
+	s->live--;
+	s->live_bytes -= h->bytes;
+	p = h;
+#endif
+	
+	free(p);
+}
+
+void mem_report(void) {
+#ifdef MEM_STATS
+	long allocs = 0, frees = 0, live = 0;
+	size_t bytes = 0, live_bytes = 0;
+	int order[MEM_SITES];
+	
+	// Sites by number of allocations
+	for(int i = 0; i < nsites; i++) {
+		int j = i;
+		
+		while (j > 0 && sites[order[j-1]].allocs < sites[i].allocs) {
+			order[j] = order[j-1];
+			j--;
+		}
+		order[j] = i;
+	}
+	
+	printf("\nAllocation report\n");
+	printf("%-24s %12s %12s %12s %12s %12s\n", "function", "allocs", "frees", "live", "MB", "live MB");
+	for(int k = 0; k < nsites; k++) {
+		MemSite *s = &sites[order[k]];
+		
+		printf("%-24s %12ld %12ld %12ld %12.3f %12.3f\n", s->name, s->allocs, s->frees,
+			   s->live, s->bytes/1048576.0, s->live_bytes/1048576.0);
+		allocs += s->allocs;
+		frees += s->frees;
+		live += s->live;
+		bytes += s->bytes;
+		live_bytes += s->live_bytes;
+	}
+	printf("%-24s %12ld %12ld %12ld %12.3f %12.3f\n", "total", allocs, frees,
+		   live, bytes/1048576.0, live_bytes/1048576.0);
+#else
+	printf("Allocation report: build with -DMEM_STATS\n");
+#endif
+}
+
+void mem_totals(long *allocs, long *live, size_t *live_bytes) {
+	*allocs = 0;
+	*live = 0;
+	*live_bytes = 0;
+	
+#ifdef MEM_STATS
+	for(int i = 0; i < nsites; i++) {
+		*allocs += sites[i].allocs;
+		*live += sites[i].live;
+		*live_bytes += sites[i].live_bytes;
+	}
+#endif
+}
+
+double *v_create_at(const char *site, int c) {
+	double *v = (double*)mem_get(site, c*sizeof(double), 1);
 	
     if (v == NULL) {
 		printf("vector create: error\n");
@@ -23,8 +188,12 @@ double *v_create(int c) {
 	return v;
 }
 
+double *v_create(int c) {
+	return v_create_at(NULL, c);
+}
+
 void v_free(double *v, int c) {
-	free(v);
+	mem_put(v);
 }
 
 void v_show(double *v, int c) {
@@ -34,8 +203,8 @@ void v_show(double *v, int c) {
     }
 }
 
-double *v_sum(double *v, int cv, double *w, int cw) {
-	double *r = v_create(cv);
+double *v_sum_at(const char *site, double *v, int cv, double *w, int cw) {
+	double *r = v_create_at(site, cv);
 	
     if (cv != cw) {
         exit(EXIT_FAILURE);
@@ -47,8 +216,12 @@ double *v_sum(double *v, int cv, double *w, int cw) {
 	return r;
 }
 
-double *v_mul_scalar(double *v, int c, double s) {
-	double *r = v_create(c);
+double *v_sum(double *v, int cv, double *w, int cw) {
+	return v_sum_at(NULL, v, cv, w, cw);
+}
+
+double *v_mul_scalar_at(const char *site, double *v, int c, double s) {
+	double *r = v_create_at(site, c);
 	
 	for(int i = 0; i < c; i++)
 		r[i] = v[i]*s;
@@ -56,6 +229,10 @@ double *v_mul_scalar(double *v, int c, double s) {
 	return r;
 }
 
+double *v_mul_scalar(double *v, int c, double s) {
+	return v_mul_scalar_at(NULL, v, c, s);
+}
+
 double v_norm(double *v, int c) {
 	double r = 0.0;
 	
@@ -81,8 +258,8 @@ double v_dot(double *v, int cv, double *w, int cw) {
 	return r;
 }
 
-double *v_cross(double *v, int cv, double *w, int cw) {
-	double *r = v_create(cv);
+double *v_cross_at(const char *site, double *v, int cv, double *w, int cw) {
+	double *r = v_create_at(site, cv);
 	
     if (cv != 3 || cw != 3) {
 		printf("vector cross: error\n");
@@ -96,25 +273,42 @@ double *v_cross(double *v, int cv, double *w, int cw) {
 	return r;
 }
 
+double *v_cross(double *v, int cv, double *w, int cw) {
+	return v_cross_at(NULL, v, cv, w, cw);
+}
 
-double **m_create(int f, int c) {
-	double **L = (double **) malloc(f*sizeof(double *));
-	for(int i = 0; i < f; i++)
-		L[i] = (double *) malloc(c*sizeof(double));
+
+double **m_create_at(const char *site, int f, int c) {
+	// Row pointers and row-major data share one contiguous block
+	double **L = (double **) mem_get(site, f*sizeof(double *) + f*c*sizeof(double), 0);
 	
     if (L == NULL) {
 		printf("matrix create: error\n");
         exit(EXIT_FAILURE);
 	}
 	
-	return L;
+	return m_wrap((double *) (L + f), L, f, c);
 }
 
-void m_free(double **L, int f, int c) {
+double **m_create(int f, int c) {
+	return m_create_at(NULL, f, c);
+}
+
+double **m_wrap(double *data, double **rows, int f, int c) {
 	for(int i = 0; i < f; i++)
-		free(L[i]);
+		rows[i] = data + i*c;
 	
-    free(L);
+	return rows;
+}
+
+void m_free(double **L, int f, int c) {
+	// Only the block of m_create, whose rows follow the f row pointers
+	if (L != NULL && f > 0 && L[0] != (double *) (L + f)) {
+		printf("matrix free: error\n");
+		exit(EXIT_FAILURE);
+	}
+	
+	mem_put(L);
 }
 
 void m_show(double **L, int f, int c) {
@@ -125,8 +319,8 @@ void m_show(double **L, int f, int c) {
     }
 }
 
-double *v_extract(double **A, int fA, int cA, int k) {
-	double *v = v_create(fA);
+double *v_extract_at(const char *site, double **A, int fA, int cA, int k) {
+	double *v = v_create_at(site, fA);
 	
     if (k < 0 || k >= cA) {
 		printf("vector extract: error\n");
@@ -140,8 +334,12 @@ double *v_extract(double **A, int fA, int cA, int k) {
 	return v;
 }
 
-double **v_assign(double *v, int cv, double **A, int fA, int cA, int k) {
-	double **L = m_create(fA,cA);
+double *v_extract(double **A, int fA, int cA, int k) {
+	return v_extract_at(NULL, A, fA, cA, k);
+}
+
+double **v_assign_at(const char *site, double *v, int cv, double **A, int fA, int cA, int k) {
+	double **L = m_create_at(site,fA,cA);
 	
     if (cv != fA || k < 0 || k >= cA) {
 		printf("vector assign: error\n");
@@ -161,8 +359,12 @@ double **v_assign(double *v, int cv, double **A, int fA, int cA, int k) {
 	return L;
 }
 
-double *v_dot_m(double *v, int cv, double **A, int fA, int cA) {
-	double *x = v_create(cA);
+double **v_assign(double *v, int cv, double **A, int fA, int cA, int k) {
+	return v_assign_at(NULL, v, cv, A, fA, cA, k);
+}
+
+double *v_dot_m_at(const char *site, double *v, int cv, double **A, int fA, int cA) {
+	double *x = v_create_at(site, cA);
 	
     if (cv != fA) {
 		printf("vector dot matrix: error\n");
@@ -178,8 +380,12 @@ double *v_dot_m(double *v, int cv, double **A, int fA, int cA) {
 	return x;
 }
 
-double *m_dot_v(double **A, int fA, int cA, double *v, int cv) {
-	double *x = v_create(fA);
+double *v_dot_m(double *v, int cv, double **A, int fA, int cA) {
+	return v_dot_m_at(NULL, v, cv, A, fA, cA);
+}
+
+double *m_dot_v_at(const char *site, double **A, int fA, int cA, double *v, int cv) {
+	double *x = v_create_at(site, fA);
 	
     if (cv != cA){
 		printf("matrix dot vector: error\n");
@@ -195,8 +401,12 @@ double *m_dot_v(double **A, int fA, int cA, double *v, int cv) {
 	return x;
 }
 
-double **m_zeros(int f, int c) {
-	double **L = m_create(f,c);
+double *m_dot_v(double **A, int fA, int cA, double *v, int cv) {
+	return m_dot_v_at(NULL, A, fA, cA, v, cv);
+}
+
+double **m_zeros_at(const char *site, int f, int c) {
+	double **L = m_create_at(site,f,c);
 	
 	for(int i = 0; i < f; i++) {
         for(int j = 0; j < c; j++) {
@@ -207,8 +417,12 @@ double **m_zeros(int f, int c) {
 	return L;
 }
 
-double **m_eye(int n) {
-	double **L = m_create(n,n);
+double **m_zeros(int f, int c) {
+	return m_zeros_at(NULL, f, c);
+}
+
+double **m_eye_at(const char *site, int n) {
+	double **L = m_create_at(site,n,n);
 	
 	for(int i = 0; i < n; i++) {
         for(int j = 0; j < n; j++) {
@@ -223,8 +437,12 @@ double **m_eye(int n) {
 	return L;
 }
 
-double **m_sum(double **A, int fA, int cA, double **B, int fB, int cB) {
-	double **L = m_zeros(fA,cA);
+double **m_eye(int n) {
+	return m_eye_at(NULL, n);
+}
+
+double **m_sum_at(const char *site, double **A, int fA, int cA, double **B, int fB, int cB) {
+	double **L = m_zeros_at(site,fA,cA);
 	
     if (fA != fB || cA != cB) {
 		printf("matrix sum: error\n");
@@ -240,8 +458,12 @@ double **m_sum(double **A, int fA, int cA, double **B, int fB, int cB) {
 	return L;
 }
 
-double **m_dot(double **A, int fA, int cA, double **B, int fB, int cB) {
-	double **L = m_zeros(fA,cA);
+double **m_sum(double **A, int fA, int cA, double **B, int fB, int cB) {
+	return m_sum_at(NULL, A, fA, cA, B, fB, cB);
+}
+
+double **m_dot_at(const char *site, double **A, int fA, int cA, double **B, int fB, int cB) {
+	double **L = m_zeros_at(site,fA,cA);
 	
     if (cA != fB) {
 		printf("matrix dot: error\n");
@@ -258,12 +480,16 @@ double **m_dot(double **A, int fA, int cA, double **B, int fB, int cB) {
 	return L;
 }
 
-double **m_inv(double **A, int n) {
+double **m_dot(double **A, int fA, int cA, double **B, int fB, int cB) {
+	return m_dot_at(NULL, A, fA, cA, B, fB, cB);
+}
+
+double **m_inv_at(const char *site, double **A, int n) {
 	double **mat, ratio, **result;
     int i, j, k;
     
-    mat = m_zeros(n, 2*n);
-    result = m_zeros(n, n);
+    mat = m_zeros_at(site, n, 2*n);
+    result = m_zeros_at(site, n, n);
     
     for(i = 0; i < n; i++)
         for(j = 0; j < n; j++)
@@ -313,8 +539,12 @@ double **m_inv(double **A, int n) {
     return result;
 }
 
-double **m_trans(double **A, int n) {
-	double **L = m_create(n, n);
+double **m_inv(double **A, int n) {
+	return m_inv_at(NULL, A, n);
+}
+
+double **m_trans_at(const char *site, double **A, int n) {
+	double **L = m_create_at(site, n, n);
 	
 	for(int i = 0; i < n; i++) {
         for(int j = 0; j < n; j++) {
@@ -324,3 +554,88 @@ double **m_trans(double **A, int n) {
 	
 	return L;
 }
+
+double **m_trans(double **A, int n) {
+	return m_trans_at(NULL, A, n);
+}
+
+void v_axpy(double a, double *x, int cx, double *y, int cy) {
+    if (cx != cy) {
+		printf("vector axpy: error\n");
+        exit(EXIT_FAILURE);
+	}
+	
+	for(int i = 0; i < cx; i++)
+		y[i] += a*x[i];
+}
+
+void v_dot_m_into(double *v, int cv, double **A, int fA, int cA, double *x) {
+    if (cv != fA) {
+		printf("vector dot matrix: error\n");
+        exit(EXIT_FAILURE);
+	}
+	
+	for(int j = 0; j < cA; j++) {
+		x[j] = 0.0;
+		for(int i = 0; i < fA; i++) {
+			x[j] += v[i]*A[i][j];
+		}
+	}
+}
+
+void m_dot_v_into(double **A, int fA, int cA, double *v, int cv, double *x) {
+    if (cv != cA){
+		printf("matrix dot vector: error\n");
+        exit(EXIT_FAILURE);
+	}
+	
+	for(int i = 0; i < fA; i++) {
+		x[i] = 0.0;
+		for(int j = 0; j < cA; j++) {
+			x[i] += v[j]*A[i][j];
+		}
+	}
+}
+
+void m_sum_into(double **A, int fA, int cA, double **B, int fB, int cB, double **L) {
+    if (fA != fB || cA != cB) {
+		printf("matrix sum: error\n");
+        exit(EXIT_FAILURE);
+	}
+	
+	for(int i = 0; i < fA; i++) {
+        for(int j = 0; j < cA; j++) {
+			L[i][j] = A[i][j] + B[i][j];
+		}
+	}
+}
+
+void m_dot_into(double **A, int fA, int cA, double **B, int fB, int cB, double **L) {
+    if (cA != fB) {
+		printf("matrix dot: error\n");
+        exit(EXIT_FAILURE);
+	}
+	
+	for(int i = 0; i < fA; i++) {
+        for(int j = 0; j < cB; j++) {
+			L[i][j] = 0.0;
+			for(int k = 0; k < cA; k++)
+				L[i][j] += A[i][k]*B[k][j];
+		}
+	}
+}
+
+void m_dot_trans_into(double **A, int fA, int cA, double **B, int fB, int cB, double **L) {
+    if (cA != cB) {
+		printf("matrix dot transpose: error\n");
+        exit(EXIT_FAILURE);
+	}
+	
+	for(int i = 0; i < fA; i++) {
+        for(int j = 0; j < fB; j++) {
+			L[i][j] = 0.0;
+			for(int k = 0; k < cA; k++)
+				L[i][j] += A[i][k]*B[j][k];
+		}
+	}
+}
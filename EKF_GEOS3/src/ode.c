@@ -8,11 +8,36 @@
  *  @bug No know bugs.
  */
 
+/*
+  clock_gettime is POSIX, outside strict ISO C.
+*/
+# define _POSIX_C_SOURCE 199309L
+
 # include <stdlib.h>
 # include <stdio.h>
 # include <math.h>
 # include <time.h>
 
+# include "../includes/arena.h"
+# include "../includes/m_utils.h"
+# include "../includes/ode.h"
+
+/*
+  Passes of the fixed point iteration of ADAMS_CORRECT.
+*/
+# define ADAMS_ITERATIONS 6
+
+/*
+  Statistics of the context being integrated, if any.
+*/
+static OdeStats *ode_stats_current = NULL;
+
+int adams_advance ( OdeContext *c, double *y, double tout );
+
+int adams_arc ( OdeContext *c, double *y, double tout, OdeArc *a );
+
+void adams_correct ( OdeContext *c, const double *y );
+
 void de ( void f ( double t, double *y, double **yp ), int neqn, double *y,
   double *t, double tout, double relerr, double abserr, int *iflag, double *yy, 
   double *wt, double *p, double *yp, double *ypout, double *phi, 
@@ -20,12 +45,34 @@ void de ( void f ( double t, double *y, double **yp ), int neqn, double *y,
   double *g, int *phase1, double *psi, double *x, double *h, double *hold, 
   int *start, double *told, double *delsgn, int *ns, int *nornd, int *k, int *kold, 
   int *isnold );
+
+int dop853 ( OdeContext *c, double *y, double tout );
+
+void dop853_correct ( OdeContext *c, const double *y );
+
+void fcn ( void f ( double t, double *y, double **yp ), double t, double *y, 
+  double *yp, int neqn );
   
+int gj8 ( OdeContext *c, double *y, double tout );
+
+void gj8_correct ( OdeContext *c, const double *y );
+
+int gj8_start ( OdeContext *c, const double *y );
+
+void gj8_step ( OdeContext *c );
+
 int i4_sign ( int i );
 
 void intrp ( double x, double *y, double xout, double *yout, double *ypout, 
   int neqn, int kold, double *phi, double *psi );
   
+void ode_arc_push ( OdeArc *a, double x, double *y, int k, double *phi,
+  double *psi );
+
+double ode_clock ( void );
+
+void ode_stats_step ( double h, int k, int accepted );
+
 double r8_abs ( double x );
 
 double r8_add ( double x, double y );
@@ -46,6 +93,402 @@ void step ( double *x, double *y, void f ( double t, double *y, double **yp ),
   
 void timestamp ( void );
 
+/*
+  Methods of a context, indexed by C->METHOD: the workspace, WORK0 +
+  WORK2 * NEQN / 2 doubles, for an even NEQN only if EVEN; the advance
+  to TOUT; the replacement of the state at C->T; and the recording
+  advance of ODE_ARC, NULL where there is none.
+*/
+typedef struct
+{
+  int work0;
+  int work2;
+  int even;
+  int ( *advance ) ( OdeContext *c, double *y, double tout );
+  void ( *correct ) ( OdeContext *c, const double *y );
+  int ( *arc ) ( OdeContext *c, double *y, double tout, OdeArc *a );
+} OdeMethod;
+
+static const OdeMethod ode_methods[] =
+{
+  { 100, 94, 0, adams_advance, adams_correct, adams_arc },
+  { 1, 28, 0, dop853, dop853_correct, NULL },
+  { 3, 17, 1, gj8, gj8_correct, NULL }
+};
+
+# define ODE_METHODS \
+  ( int ) ( sizeof ( ode_methods ) / sizeof ( ode_methods[0] ) )
+/******************************************************************************/
+
+int adams_advance ( OdeContext *c, double *y, double tout )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    ADAMS_ADVANCE integrates an ODE_ADAMS context to TOUT by ODE.
+
+  Discussion:
+
+    The integration is asked to stop at TOUT (negative IFLAG), so that
+    the state held in the workspace is the state at TOUT and can be
+    corrected there.  DE restarts after a call with negative IFLAG,
+    as it cannot tell whether the user will continue from that point;
+    the context can, so ISNOLD is set positive before every warm call.
+
+  Parameters:
+
+    Input, OdeContext *C, the context.
+
+    Input/output, double Y[NEQN], the state.  Input only on the first
+    call after ODE_START.
+
+    Input, double TOUT, the desired value of T on output.
+
+    Output, int ADAMS_ADVANCE, the status, as IFLAG of ODE.
+*/
+{
+  int iflag;
+
+  if ( c->iflag == 1 )
+  {
+    iflag = -1;
+  }
+  else
+  {
+    iflag = -2;
+    c->iwork[4] = 1;
+  }
+
+  for ( ; ; )
+  {
+    ode ( c->f, c->neqn, y, &c->t, tout, c->relerr, c->abserr, &iflag, 
+      c->work, c->iwork );
+/*
+  More than 500 steps: carry on from where DE stopped.
+*/
+    if ( abs ( iflag ) != 4 )
+    {
+      break;
+    }
+    iflag = -2;
+    c->iwork[4] = 1;
+  }
+
+  c->iflag = iflag;
+
+  return iflag;
+}
+/******************************************************************************/
+
+int adams_arc ( OdeContext *c, double *y, double tout, OdeArc *a )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    ADAMS_ARC integrates an ODE_ADAMS context to TOUT, recording every step.
+
+  Discussion:
+
+    This is the loop of DE without its output points: STEP is called
+    with the step sizes it chooses, shortened only to end at TOUT,
+    and the polynomial of every step is added to the arc.  When the
+    tolerances are too small they are increased, as DE does, and the
+    integration goes on; the increased tolerances are left in
+    C->RELERR and C->ABSERR, and the status is then 3.  On return the
+    context is set as after ODE_ADVANCE.
+
+  Parameters:
+
+    Input, OdeContext *C, the context.
+
+    Input/output, double Y[NEQN], the state.  Input only on the first
+    call after ODE_START.
+
+    Input, double TOUT, the end of the arc.
+
+    Input/output, OdeArc *A, the arc.
+
+    Output, int ADAMS_ARC, the status: 2 on success, 3 if the
+    tolerances were increased on the way to TOUT.
+*/
+{
+  const int ialpha = 1;
+  const int ibeta = 13;
+  const int idelsn = 93;
+  const int ig = 62;
+  const int ih = 89;
+  const int ihold = 90;
+  const int iphase = 75;
+  const int ipsi = 76;
+  const int isig = 25;
+  const int istart = 91;
+  const int itold = 92;
+  const int iv = 38;
+  const int iw = 50;
+  const int ix = 88;
+  const int iyy = 100;
+  double abseps;
+  int crash;
+  double del;
+  double eps;
+  double fouru;
+  int iflag;
+  int l;
+  int neqn;
+  int nornd;
+  double *phi;
+  int phase1;
+  double releps;
+  int start;
+  double *w;
+  double *wt;
+  double *x;
+  double *yy;
+
+  neqn = c->neqn;
+  w = c->work;
+  x = w + ix - 1;
+  yy = w + iyy - 1;
+  wt = yy + neqn;
+  phi = yy + 5 * neqn;
+  fouru = 4.0 * r8_epsilon ( );
+  eps = r8_max ( c->relerr, c->abserr );
+  releps = c->relerr / eps;
+  abseps = c->abserr / eps;
+  del = tout - c->t;
+  iflag = 2;
+/*
+  On start and change of direction, set X, YY and the step size as
+  DE does, and empty the arc.
+*/
+  if ( c->iflag == 1 || w[idelsn-1] * del <= 0.0 )
+  {
+    start = 1;
+    phase1 = 1;
+    nornd = 1;
+    *x = c->t;
+    for ( l = 0; l < neqn; l++ )
+    {
+      yy[l] = y[l];
+    }
+    w[idelsn-1] = r8_sign ( del );
+    w[ih-1] = r8_max ( r8_abs ( tout - *x ), fouru * r8_abs ( *x ) ) 
+      * r8_sign ( tout - *x );
+    a->n = 0;
+  }
+  else
+  {
+    start = ( 0.0 < w[istart-1] );
+    phase1 = ( 0.0 < w[iphase-1] );
+    nornd = ( c->iwork[1] != -1 );
+  }
+
+  while ( 0.0 < ( tout - *x ) * w[idelsn-1] && 
+    fouru * r8_abs ( *x ) <= r8_abs ( tout - *x ) )
+  {
+    w[ih-1] = r8_min ( r8_abs ( w[ih-1] ), r8_abs ( tout - *x ) ) 
+      * r8_sign ( w[ih-1] );
+
+    for ( l = 0; l < neqn; l++ )
+    {
+      wt[l] = releps * r8_abs ( yy[l] ) + abseps;
+    }
+
+    step ( x, yy, c->f, neqn, w+ih-1, &eps, wt, &start, 
+      w+ihold-1, c->iwork+2, c->iwork+3, &crash, phi, yy+2*neqn, yy+3*neqn, 
+      w+ipsi-1, w+ialpha-1, w+ibeta-1, w+isig-1, w+iv-1, w+iw-1, w+ig-1, 
+      &phase1, c->iwork+0, &nornd );
+
+    if ( crash )
+    {
+      iflag = 3;
+    }
+    else
+    {
+      ode_arc_push ( a, *x, yy, c->iwork[3], phi, w+ipsi-1 );
+    }
+  }
+/*
+  Leave the context as ODE_ADVANCE does.
+*/
+  for ( l = 0; l < neqn; l++ )
+  {
+    y[l] = yy[l];
+  }
+  c->relerr = eps * releps;
+  c->abserr = eps * abseps;
+  c->t = tout;
+  c->iflag = iflag;
+  c->iwork[4] = 1;
+  w[itold-1] = tout;
+  w[istart-1] = start ? 1.0 : -1.0;
+  w[iphase-1] = phase1 ? 1.0 : -1.0;
+  c->iwork[1] = nornd ? 1 : -1;
+
+  return iflag;
+}
+/******************************************************************************/
+
+void adams_correct ( OdeContext *c, const double *y )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    ADAMS_CORRECT rebuilds the Adams history of a context for a new state.
+
+  Discussion:
+
+    After a step PHI(*,1:KOLD+1) are the modified divided differences
+    of the derivatives at the nodes X - PSI(J), J = 0, ..., KOLD
+    (PSI(0) = 0), that is, PHI(*,I) is PSI(1) * ... * PSI(I-1) times
+    the divided difference of the derivatives at the first I nodes.
+
+    The solution through the new state Y at X is found at the past
+    nodes by fixed point iteration: the derivatives at the nodes are
+    evaluated on the current estimate, PHI is rebuilt from them, and
+    INTRP integrates the new polynomial from Y back to the nodes.  The
+    first estimate is the old solution moved by the correction DY and
+    by (T - X) times the change of the derivative at X.  The iteration
+    stops when no node moves by more than the error tolerance, or
+    after ADAMS_ITERATIONS passes; either way the step size, the order
+    and the step history are kept.
+
+    PHI(*,KOLD+2), used only to test raising the order, is left as it
+    was.  The work space holds the node states and derivatives past
+    the 100+21*NEQN of ODE.
+
+  Parameters:
+
+    Input, OdeContext *C, the context, with at least one step taken.
+
+    Input, const double Y[NEQN], the new state at C->T.
+*/
+{
+  const int ipsi = 76;
+  const int ix = 88;
+  const int iyy = 100;
+  double *dd;
+  double d;
+  double err;
+  int it;
+  int j;
+  int kold;
+  int l;
+  int m;
+  int neqn;
+  double *phi;
+  double *psi;
+  double q;
+  double *tmp;
+  double *x;
+  double *yn;
+  double *yp;
+  double *ypout;
+  double *yy;
+
+  neqn = c->neqn;
+  kold = c->iwork[3];
+  psi = c->work + ipsi - 1;
+  x = c->work + ix - 1;
+  yy = c->work + iyy - 1;
+  yp = yy + 3 * neqn;
+  ypout = yp + neqn;
+  phi = ypout + neqn;
+  yn = c->work + 99 + 21 * neqn;
+  dd = yn + 12 * neqn;
+  tmp = dd + 13 * neqn;
+/*
+  Derivative at X on the new state, and the first estimate at the nodes.
+*/
+  fcn ( c->f, *x, ( double * ) y, dd, neqn );
+
+  for ( m = 1; m <= kold; m++ )
+  {
+    intrp ( *x, yy, *x - psi[m-1], yn + ( m - 1 ) * neqn, ypout, neqn, kold, 
+      phi, psi );
+    for ( l = 0; l < neqn; l++ )
+    {
+      yn[( m - 1 ) * neqn + l] = yn[( m - 1 ) * neqn + l] + y[l] - yy[l] 
+        - psi[m-1] * ( dd[l] - phi[l] );
+    }
+  }
+
+  for ( l = 0; l < neqn; l++ )
+  {
+    yy[l] = y[l];
+    yp[l] = dd[l];
+  }
+
+  for ( it = 1; it <= ADAMS_ITERATIONS; it++ )
+  {
+/*
+  Derivatives at the nodes, and their divided differences in place.
+*/
+    for ( l = 0; l < neqn; l++ )
+    {
+      dd[l] = yp[l];
+    }
+    for ( m = 1; m <= kold; m++ )
+    {
+      fcn ( c->f, *x - psi[m-1], yn + ( m - 1 ) * neqn, dd + m * neqn, neqn );
+    }
+
+    for ( j = 1; j <= kold; j++ )
+    {
+      for ( m = kold; j <= m; m-- )
+      {
+        d = psi[m-1] - ( ( m - j == 0 ) ? 0.0 : psi[m-j-1] );
+        for ( l = 0; l < neqn; l++ )
+        {
+          dd[m*neqn+l] = ( dd[(m-1)*neqn+l] - dd[m*neqn+l] ) / d;
+        }
+      }
+    }
+
+    q = 1.0;
+    for ( j = 0; j <= kold; j++ )
+    {
+      for ( l = 0; l < neqn; l++ )
+      {
+        phi[j*neqn+l] = q * dd[j*neqn+l];
+      }
+      if ( j < kold )
+      {
+        q = q * psi[j];
+      }
+    }
+/*
+  The new polynomial back to the nodes.
+*/
+    err = 0.0;
+    for ( m = 1; m <= kold; m++ )
+    {
+      intrp ( *x, yy, *x - psi[m-1], tmp, ypout, neqn, kold, phi, psi );
+      for ( l = 0; l < neqn; l++ )
+      {
+        d = r8_abs ( tmp[l] - yn[( m - 1 ) * neqn + l] ) 
+          / ( c->relerr * r8_abs ( tmp[l] ) + c->abserr );
+        err = r8_max ( err, d );
+        yn[( m - 1 ) * neqn + l] = tmp[l];
+      }
+    }
+
+    if ( err <= 1.0 )
+    {
+      break;
+    }
+  }
+
+  for ( l = 0; l < neqn; l++ )
+  {
+    ypout[l] = yp[l];
+  }
+
+  return;
+}
 /******************************************************************************/
 
 void de 
@@ -355,7 +798,7 @@ void de
     if ( isn <= 0 && r8_abs ( tout - *x ) < fouru * r8_abs ( *x ) )
     {
       *h = tout - *x;
-      f ( *x, yy, &yp );
+      fcn ( f, *x, yy, yp, neqn );
       for ( l = 1; l <= neqn; l++ )
       {
         y[l-1] = yy[l-1] + *h * yp[l-1];
@@ -435,208 +878,1220 @@ void de
 }
 /******************************************************************************/
 
-int i4_sign ( int i )
+int dop853 ( OdeContext *c, double *y, double tout )
 
 /******************************************************************************/
 /*
   Purpose:
 
-    I4_SIGN returns the sign of an I4.
-
-  Licensing:
+    DOP853 integrates a context to TOUT by the Dormand-Prince 8(5,3) method.
 
-    This code is distributed under the GNU LGPL license.
+  Discussion:
 
-  Modified:
+    This is the stepping of DOP853 of Hairer and Wanner: an explicit
+    Runge-Kutta method of order 8 with 12 stages, whose derivative at
+    the end of a step is the first stage of the next one, and an error
+    estimate which combines embedded methods of orders 5 and 3.  The
+    step size control is that of DOP853 with its default parameters.
+    The step that would pass TOUT is shortened to end there, and the
+    step size proposed before that is kept for the next call.
 
-    23 October 2007
+    The workspace holds the step size, the state at C->T, the 12
+    stages and the trial state; nothing is allocated here.
 
-  Author:
+  Reference:
 
-    John Burkardt
+    Ernst Hairer, Syvert Norsett, Gerhard Wanner,
+    Solving Ordinary Differential Equations I: Nonstiff Problems,
+    Second Edition,
+    Springer, 1993.
 
   Parameters:
 
-    Input, int I, the integer whose sign is desired.
+    Input, OdeContext *C, the context.
 
-    Output, int I4_SIGN, the sign of I.
+    Input/output, double Y[NEQN], the state.  Input only on the first
+    call after ODE_START.
+
+    Input, double TOUT, the desired value of T on output.
+
+    Output, int DOP853, the status: 2 on success, 3 if the step size
+    became too small for the tolerances.
 */
 {
-  int value;
-
-  if ( i < 0 )
+  static const double a[12][11] = {
+    { 0.0 },
+    { 5.26001519587677318785587544488E-02 },
+    { 1.97250569845378994544595329183E-02, 5.91751709536136983633785987549E-02 },
+    { 2.95875854768068491816892993775E-02, 0.0, 8.87627564304205475450678981324E-02 },
+    { 2.41365134159266685502369798665E-01, 0.0, -8.84549479328286085344864962717E-01,
+      9.24834003261792003115737966543E-01 },
+    { 3.70370370370370370370370370370E-02, 0.0, 0.0, 1.70828608729473871279604482173E-01,
+      1.25467687566822425016691814123E-01 },
+    { 3.7109375E-02, 0.0, 0.0, 1.70252211019544039314978060272E-01,
+      6.02165389804559606850219397283E-02, -1.7578125E-02 },
+    { 3.70920001185047927108779319836E-02, 0.0, 0.0, 1.70383925712239993810214054705E-01,
+      1.07262030446373284651809199168E-01, -1.53194377486244017527936158236E-02,
+      8.27378916381402288758473766002E-03 },
+    { 6.24110958716075717114429577812E-01, 0.0, 0.0, -3.36089262944694129406857109825,
+      -8.68219346841726006818189891453E-01, 2.75920996994467083049415600797E+01,
+      2.01540675504778934086186788979E+01, -4.34898841810699588477366255144E+01 },
+    { 4.77662536438264365890433908527E-01, 0.0, 0.0, -2.48811461997166764192642586468,
+      -5.90290826836842996371446475743E-01, 2.12300514481811942347288949897E+01,
+      1.52792336328824235832596922938E+01, -3.32882109689848629194453265587E+01,
+      -2.03312017085086261358222928593E-02 },
+    { -9.37142430085987325717040216580E-01, 0.0, 0.0, 5.18637242884406370830023853209,
+      1.09143734899672957818500254654, -8.14978701074692612513997267357,
+      -1.85200656599969598641566180701E+01, 2.27394870993505042818970056734E+01,
+      2.49360555267965238987089396762, -3.04676447189821950038236690220 },
+    { 2.27331014751653820792359768449, 0.0, 0.0, -1.05344954667372501984066689879E+01,
+      -2.00087205822486249909675718444, -1.79589318631187989172765950534E+01,
+      2.79488845294199600508499808837E+01, -2.85899827713502369474065508674,
+      -8.87285693353062954433549289258, 1.23605671757943030647266201528E+01,
+      6.43392746015763530355970484046E-01 } };
+  static const double b[12] = {
+    5.42937341165687622380535766363E-02, 0.0, 0.0, 0.0, 0.0,
+    4.45031289275240888144113950566, 1.89151789931450038304281599044,
+    -5.80120396001058478146721142270, 3.11164366957819894408916062370E-01,
+    -1.52160949662516078556178806805E-01, 2.01365400804030348374776537501E-01,
+    4.47106157277725905176885569043E-02 };
+  static const double bhh[3] = {
+    2.44094488188976377952755905512E-01, 7.33846688281611857341361741547E-01,
+    2.20588235294117647058823529412E-02 };
+  static const double cs[12] = {
+    0.0, 5.26001519587677318785587544488E-02, 7.89002279381515978178381316732E-02,
+    1.18350341907227396726757197510E-01, 2.81649658092772603273242802490E-01,
+    3.33333333333333333333333333333E-01, 2.5E-01, 3.07692307692307692307692307692E-01,
+    6.51282051282051282051282051282E-01, 6.0E-01, 8.57142857142857142857142857142E-01,
+    1.0 };
+  static const double er[12] = {
+    1.312004499419488073250102996E-02, 0.0, 0.0, 0.0, 0.0,
+    -1.225156446376204440720569753, -4.957589496572501915214079952E-01,
+    1.664377182454986536961530415, -3.503288487499736816886487290E-01,
+    3.341791187130174790297318841E-01, 8.192320648511571246570742613E-02,
+    -2.235530786388629525884427845E-02 };
+  const double facc1 = 1.0 / 0.333;
+  const double facc2 = 1.0 / 6.0;
+  const double safe = 0.9;
+  double deno;
+  double der;
+  double dnf;
+  double dny;
+  double e3;
+  double e5;
+  double err;
+  double err2;
+  double fac11;
+  double h;
+  double hkeep;
+  double hnew;
+  int i;
+  int j;
+  double *k;
+  int l;
+  int last;
+  int neqn;
+  double posneg;
+  int reject;
+  double s;
+  double sk;
+  double *y0;
+  double *y1;
+
+  neqn = c->neqn;
+  y0 = c->work + 1;
+  k = y0 + neqn;
+  y1 = k + 12 * neqn;
+
+  if ( c->t == tout )
   {
-    value = -1;
+    return 2;
   }
-  else
+  posneg = r8_sign ( tout - c->t );
+/*
+  Cold start: the derivative at the initial state, and the initial
+  step size of DOP853 from the first and second derivatives.
+*/
+  if ( c->iflag == 1 )
   {
-    value = 1;
-  }
-  return value;
-}
-/******************************************************************************/
+    for ( l = 0; l < neqn; l++ )
+    {
+      y0[l] = y[l];
+    }
+    fcn ( c->f, c->t, y0, k, neqn );
 
-void intrp 
-( 
-  double x,
-  double *y,
-  double xout,
-  double *yout,
-  double *ypout, 
-  int neqn,
-  int kold,
-  double *phi,
-  double *psi 
-)
+    dnf = 0.0;
+    dny = 0.0;
+    for ( l = 0; l < neqn; l++ )
+    {
+      sk = c->abserr + c->relerr * r8_abs ( y0[l] );
+      dnf = dnf + pow ( k[l] / sk, 2 );
+      dny = dny + pow ( y0[l] / sk, 2 );
+    }
+    if ( dnf <= 1.0E-10 || dny <= 1.0E-10 )
+    {
+      h = 1.0E-06;
+    }
+    else
+    {
+      h = sqrt ( dny / dnf ) * 0.01;
+    }
+    h = posneg * r8_min ( h, r8_abs ( tout - c->t ) );
+
+    for ( l = 0; l < neqn; l++ )
+    {
+      y1[l] = y0[l] + h * k[l];
+    }
+    fcn ( c->f, c->t + h, y1, k + neqn, neqn );
+
+    der = 0.0;
+    for ( l = 0; l < neqn; l++ )
+    {
+      sk = c->abserr + c->relerr * r8_abs ( y0[l] );
+      der = der + pow ( ( k[neqn+l] - k[l] ) / sk, 2 );
+    }
+    der = r8_max ( sqrt ( der ) / r8_abs ( h ), sqrt ( dnf ) );
+    if ( der <= 1.0E-15 )
+    {
+      hnew = r8_max ( 1.0E-06, r8_abs ( h ) * 1.0E-03 );
+    }
+    else
+    {
+      hnew = pow ( 0.01 / der, 1.0 / 8.0 );
+    }
+    c->work[0] = r8_min ( r8_min ( 100.0 * r8_abs ( h ), hnew ), 
+      r8_abs ( tout - c->t ) );
+  }
+
+  h = posneg * r8_abs ( c->work[0] );
+  reject = 0;
+
+  for ( ; ; )
+  {
+    if ( r8_abs ( h ) <= 16.0 * r8_epsilon ( ) * r8_abs ( c->t ) )
+    {
+      c->iflag = 3;
+      break;
+    }
+/*
+  The step that would pass TOUT, or nearly reach it, ends there.
+*/
+    hkeep = h;
+    last = 0;
+    if ( 0.0 <= ( c->t + 1.01 * h - tout ) * posneg )
+    {
+      h = tout - c->t;
+      last = 1;
+    }
+/*
+  Stages 2 to 12; stage 1 is the derivative at C->T.
+*/
+    for ( i = 1; i < 12; i++ )
+    {
+      for ( l = 0; l < neqn; l++ )
+      {
+        s = 0.0;
+        for ( j = 0; j < i; j++ )
+        {
+          s = s + a[i][j] * k[j*neqn+l];
+        }
+        y1[l] = y0[l] + h * s;
+      }
+      fcn ( c->f, c->t + cs[i] * h, y1, k + i * neqn, neqn );
+    }
+/*
+  The new state, and the error estimate of orders 5 and 3.
+*/
+    err = 0.0;
+    err2 = 0.0;
+    for ( l = 0; l < neqn; l++ )
+    {
+      s = 0.0;
+      e5 = 0.0;
+      for ( i = 0; i < 12; i++ )
+      {
+        s = s + b[i] * k[i*neqn+l];
+        e5 = e5 + er[i] * k[i*neqn+l];
+      }
+      e3 = s - bhh[0] * k[l] - bhh[1] * k[8*neqn+l] - bhh[2] * k[11*neqn+l];
+      y1[l] = y0[l] + h * s;
+      sk = c->abserr + c->relerr * r8_max ( r8_abs ( y0[l] ), r8_abs ( y1[l] ) );
+      err = err + pow ( e5 / sk, 2 );
+      err2 = err2 + pow ( e3 / sk, 2 );
+    }
+    deno = err + 0.01 * err2;
+    if ( deno <= 0.0 )
+    {
+      deno = 1.0;
+    }
+    err = r8_abs ( h ) * err * sqrt ( 1.0 / ( neqn * deno ) );
+
+    fac11 = pow ( err, 1.0 / 8.0 );
+    hnew = h / r8_max ( facc2, r8_min ( facc1, fac11 / safe ) );
+/*
+  Step accepted: its end derivative is the first stage of the next.
+*/
+    if ( err <= 1.0 )
+    {
+      if ( last )
+      {
+        c->t = tout;
+      }
+      else
+      {
+        c->t = c->t + h;
+      }
+      for ( l = 0; l < neqn; l++ )
+      {
+        y0[l] = y1[l];
+      }
+      fcn ( c->f, c->t, y0, k, neqn );
+
+      ode_stats_step ( h, 8, 1 );
+      if ( reject )
+      {
+        hnew = posneg * r8_min ( r8_abs ( hnew ), r8_abs ( h ) );
+      }
+      reject = 0;
+      if ( last )
+      {
+        h = posneg * r8_max ( r8_abs ( hnew ), r8_abs ( hkeep ) );
+        c->iflag = 2;
+        break;
+      }
+      h = hnew;
+    }
+/*
+  Step rejected.
+*/
+    else
+    {
+      ode_stats_step ( h, 8, 0 );
+      h = h / r8_min ( facc1, fac11 / safe );
+      reject = 1;
+    }
+  }
+
+  c->work[0] = h;
+  for ( l = 0; l < neqn; l++ )
+  {
+    y[l] = y0[l];
+  }
+
+  return c->iflag;
+}
+/******************************************************************************/
+
+void dop853_correct ( OdeContext *c, const double *y )
 
 /******************************************************************************/
 /*
   Purpose:
 
-    INTRP approximates the solution at XOUT by polynomial interpolation.
+    DOP853_CORRECT replaces the state of an ODE_DOP853 context.
 
   Discussion:
 
-    The methods in STEP approximate the solution near X by a polynomial.
-    This routine approximates the solution at XOUT by evaluating the
-    polynomial there.  Information defining this polynomial is passed
-    from STEP, so INTRP cannot be used alone.
+    DOP853 keeps the state and the derivative at C->T only, the first
+    stage of its next step, so the derivative is evaluated at Y.
 
-  Licensing:
+  Parameters:
 
-    This code is distributed under the GNU LGPL license.
+    Input, OdeContext *C, the context.
 
-  Modified:
+    Input, double Y[NEQN], the new state at C->T.
+*/
+{
+  int l;
+  double *yy;
 
-    01 February 2012
+  yy = c->work + 1;
+  for ( l = 0; l < c->neqn; l++ )
+  {
+    yy[l] = y[l];
+  }
+  fcn ( c->f, c->t, yy, yy + c->neqn, c->neqn );
 
-  Author:
+  return;
+}
+/******************************************************************************/
 
-    Original FORTRAN77 version by Lawrence Shampine, Marilyn Gordon.
-    C version by John Burkardt.
+void fcn ( void f ( double t, double *y, double **yp ), double t, double *y, 
+  double *yp, int neqn )
 
-  Reference:
+/******************************************************************************/
+/*
+  Purpose:
 
-    Lawrence Shampine, Marilyn Gordon,
-    Computer Solution of Ordinary Differential Equations:
-    The Initial Value Problem,
-    Freeman, 1975,
-    ISBN: 0716704617,
-    LC: QA372.S416.
+    FCN evaluates the right hand side of the ODE into the workspace.
 
-  Parameters:
+  Discussion:
 
-    Input, double X, the point where the solution has been computed.
+    F allocates the derivative it returns, and usually some temporaries
+    too. The derivative is copied into YP and released. If an arena is
+    bound, everything F allocated from it is released as well, so the
+    arena only has to hold the temporaries of a single evaluation.
 
-    Input, double Y[NEQN], the computed solution at X.
+    The evaluation, and the time it takes, are added to the statistics
+    of the context being integrated.
 
-    Input, double XOUT, the point at which the solution is desired.
+  Parameters:
 
-    Output, double YOUT[NEQN], the solution at XOUT.
+    Input, void F ( double t, double y[], double **yp ), the user-supplied
+    function which evaluates the right hand sides of the ODE.
 
-    Output, double YPOUT[NEQN], the derivative of the solution
-    at XOUT.
+    Input, double T, the value of the independent variable.
+
+    Input, double Y[NEQN], the value of the solution.
+
+    Output, double YP[NEQN], the derivative of the solution.
 
     Input, int NEQN, the number of equations.
+*/
+{
+  Arena *a;
+  double *dy;
+  int l;
+  size_t mark = 0;
+  double t0 = 0.0;
 
-    Input, int KOLD, the order used for the last
-    successful step.
+  a = arena_current ( );
+  if ( a != NULL )
+  {
+    mark = arena_mark ( a );
+  }
 
-    Input, double PHI[NEQN*16], contains information about the
-    interpolating polynomial.
+  if ( ode_stats_current != NULL )
+  {
+    t0 = ode_clock ( );
+  }
 
-    Input, double PSI[12], contains information about the
-    interpolating polynomial.
+  f ( t, y, &dy );
+
+  if ( ode_stats_current != NULL )
+  {
+    ode_stats_current->evals = ode_stats_current->evals + 1;
+    ode_stats_current->f_time = ode_stats_current->f_time + ode_clock ( ) - t0;
+  }
+
+  for ( l = 1; l <= neqn; l++ )
+  {
+    yp[l-1] = dy[l-1];
+  }
+
+  if ( a != NULL )
+  {
+    arena_release ( a, mark );
+  }
+  else
+  {
+    v_free ( dy, neqn );
+  }
+  return;
+}
+/******************************************************************************/
+/*
+  Coefficients of GJ8, the Gauss-Jackson method of order 8 in summed
+  form.  Row J+4 of GJ8_A (J = -4..4) gives the position at node J of
+  a window of accelerations at the nodes -4..4, and row 9 the
+  prediction at node 5:
+
+    R(J) = H**2 * ( S(J) + sum ( 0 <= I <= 8 ) GJ8_A(J+4,I) * A(I-4) / 159667200 )
+
+  GJ8_B likewise gives the velocity from the first sum:
+
+    V(J) = H * ( S1(J) + sum ( 0 <= I <= 8 ) GJ8_B(J+4,I) * A(I-4) / 7257600 )
+
+  and its row 9 is the prediction at node 5 less S1(4) + A(4) / 2.  They
+  are the Euler-Maclaurin corrections of the trapezoidal first sum
+  S1(J+1) = S1(J) + ( A(J) + A(J+1) ) / 2 and of the second sum
+  S(J+1) = S(J) + S1(J) + A(J) / 2, applied to the interpolating
+  polynomial of the window, and are exact for accelerations of
+  degree 8.
+*/
+static const double gj8_a[10][9] = {
+    { 9751299.0, 16036748.0, -34806724.0, 48315732.0, -45851950.0,
+      29482676.0, -12309348.0, 3017324.0, -330157.0 },
+    { -330157.0, 12722712.0, 4151096.0, -7073536.0, 6715950.0,
+      -4252168.0, 1749488.0, -423696.0, 45911.0 },
+    { 45911.0, -743356.0, 14375508.0, 294572.0, -1288750.0,
+      931164.0, -395644.0, 96692.0, -10497.0 },
+    { -10497.0, 140384.0, -1121248.0, 15257256.0, -1028050.0,
+      33872.0, 49416.0, -17752.0, 2219.0 },
+    { 2219.0, -30468.0, 220268.0, -1307644.0, 15536850.0,
+      -1307644.0, 220268.0, -30468.0, 2219.0 },
+    { 2219.0, -17752.0, 49416.0, 33872.0, -1028050.0,
+      15257256.0, -1121248.0, 140384.0, -10497.0 },
+    { -10497.0, 96692.0, -395644.0, 931164.0, -1288750.0,
+      294572.0, 14375508.0, -743356.0, 45911.0 },
+    { 45911.0, -423696.0, 1749488.0, -4252168.0, 6715950.0,
+      -7073536.0, 4151096.0, 12722712.0, -330157.0 },
+    { -330157.0, 3017324.0, -12309348.0, 29482676.0, -45851950.0,
+      48315732.0, -34806724.0, 16036748.0, 9751299.0 },
+    { 9751299.0, -88091848.0, 354064088.0, -831418464.0, 1258146350.0,
+      -1274515624.0, 867424848.0, -385853488.0, 103798439.0 } };
+
+static const double gj8_b[10][9] = {
+    { 1546047.0, -4274870.0, 6996434.0, -9005886.0, 8277760.0,
+      -5232322.0, 2161710.0, -526154.0, 57281.0 },
+    { 57281.0, 1030518.0, -2212754.0, 2184830.0, -1788480.0,
+      1060354.0, -420718.0, 99594.0, -10625.0 },
+    { -10625.0, 152906.0, 648018.0, -1320254.0, 846080.0,
+      -449730.0, 167854.0, -38218.0, 3969.0 },
+    { 3969.0, -46346.0, 295790.0, 314622.0, -820160.0,
+      345986.0, -116334.0, 24970.0, -2497.0 },
+    { -2497.0, 26442.0, -136238.0, 505538.0, 0.0,
+      -505538.0, 136238.0, -26442.0, 2497.0 },
+    { 2497.0, -24970.0, 116334.0, -345986.0, 820160.0,
+      -314622.0, -295790.0, 46346.0, -3969.0 },
+    { -3969.0, 38218.0, -167854.0, 449730.0, -846080.0,
+      1320254.0, -648018.0, -152906.0, 10625.0 },
+    { 10625.0, -99594.0, 420718.0, -1060354.0, 1788480.0,
+      -2184830.0, 2212754.0, -1030518.0, -57281.0 },
+    { -57281.0, 526154.0, -2161710.0, 5232322.0, -8277760.0,
+      9005886.0, -6996434.0, 4274870.0, -1546047.0 },
+    { 2082753.0, -18802058.0, 75505262.0, -177112962.0, 267659200.0,
+      -270704638.0, 183957138.0, -81975542.0, 23019647.0 } };
+/******************************************************************************/
+
+int gj8 ( OdeContext *c, double *y, double tout )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    GJ8 integrates a context to TOUT by the Gauss-Jackson method of order 8.
+
+  Discussion:
+
+    The equations are of second order: Y = ( X, X' ) with NEQN / 2
+    components each, and F returns ( X', X" ).  The method takes fixed
+    steps of C->H in summed form, predicting the state at the next
+    node from the accelerations at the last nine, evaluating there
+    and correcting; the correction is repeated, with a new
+    evaluation, until it changes the state by less than the
+    tolerances, which usually takes no repetition, so a step costs
+    a single evaluation.
+
+    The state at TOUT is interpolated between the nodes by
+    integrating the polynomial through the last nine accelerations
+    from the newest node.  Nodes are not added until TOUT is passed,
+    so the next call goes on from them; a TOUT before the window
+    starts the method again from the newest node, backwards.
+
+    The workspace holds the epoch and the index of the newest node,
+    the step, the nine accelerations, the first and second sums, the
+    state at the newest node, and scratch.
+
+  Reference:
+
+    Matthew Berry, Liam Healy,
+    Implementation of Gauss-Jackson Integration for Orbit Propagation,
+    The Journal of the Astronautical Sciences,
+    Volume 52, Number 3, 2004, pages 331-357.
+
+  Parameters:
+
+    Input, OdeContext *C, the context.
+
+    Input/output, double Y[NEQN], the state.  Input only on the first
+    call after ODE_START.
+
+    Input, double TOUT, the desired value of T on output.
+
+    Output, int GJ8, the status: 2 on success, 6 if the step is too
+    large for the starting iteration to converge.
 */
 {
-  double eta;
-  double g[13];
-  double gamma;
-  double hi;
+  static const double xi[5] = {
+    -0.906179845938663992797626878299, -0.538469310105683091036314420700,
+    0.0, 0.538469310105683091036314420700, 0.906179845938663992797626878299 };
+  static const double wi[5] = {
+    0.236926885056189087514264040720, 0.478628670499366468041291514836,
+    0.568888888888888888888888888889, 0.478628670499366468041291514836,
+    0.236926885056189087514264040720 };
+  double *acc;
+  int d;
+  int g;
+  double h;
   int i;
   int j;
-  int k;
-  int ki;
-  double psijm1;
-  double rho[13];
-  double term;
-  double w[13];
+  int l;
+  double li;
+  double sigma;
+  double tn;
+  double u;
+  double w1[9];
+  double w2[9];
+  double *yn;
+
+  if ( c->t == tout )
+  {
+    return 2;
+  }
 
-  hi = xout - x;
-  ki = kold + 1;
+  d = c->neqn / 2;
+  acc = c->work + 3;
+  yn = acc + 11 * d;
 /*
-  Initialize W for computing G.
+  Cold start at C->T, or again from the newest node when TOUT is
+  before the window.
 */
-  for ( i = 1; i <= ki; i++ )
+  if ( c->iflag == 1 )
   {
-    w[i-1] = 1.0 / ( double ) ( i );
+    if ( c->h == 0.0 )
+    {
+      fprintf ( stderr, "\n" );
+      fprintf ( stderr, "GJ8 - Fatal error!\n" );
+      fprintf ( stderr, "  The step C->H is 0.\n" );
+      exit ( 1 );
+    }
+    c->work[1] = r8_sign ( tout - c->t ) * r8_abs ( c->h );
+    if ( !gj8_start ( c, y ) )
+    {
+      c->iflag = 6;
+      return 6;
+    }
+  }
+  else
+  {
+    h = c->work[1];
+    tn = c->work[0] + c->work[2] * h;
+    if ( ( tout - ( tn - 8.0 * h ) ) * h < 0.0 )
+    {
+      c->t = tn;
+      c->work[1] = -h;
+      if ( !gj8_start ( c, yn ) )
+      {
+        c->iflag = 6;
+        return 6;
+      }
+    }
   }
-/*
-  Compute G.
-*/
-  g[0] = 1.0;
-  rho[0] = 1.0;
-  term = 0.0;
 
-  for ( j = 2; j <= ki; j++ )
+  h = c->work[1];
+  for ( ; ; )
   {
-    psijm1 = psi[j-2];
-    gamma = ( hi + term ) / psijm1;
-    eta = hi / psijm1;
-    for ( i = 1; i <= ki + 1 - j; i++ )
+    tn = c->work[0] + c->work[2] * h;
+    if ( ( tout - tn ) * h <= 0.0 )
     {
-      w[i-1] = gamma * w[i-1] - eta * w[i];
+      break;
     }
-    g[j-1] = w[0];
-    rho[j-1] = gamma * rho[j-2];
-    term = psijm1;
+    gj8_step ( c );
   }
 /*
-  Interpolate.
+  Interpolation from the newest node: the weights of the nine
+  accelerations in the integrals from 0 to SIGMA of P(U) and of
+  ( SIGMA - U ) * P(U), P the polynomial through the accelerations at
+  U = -8..0, by the Gauss-Legendre rule of 5 points, exact for them.
 */
-  for ( k = 0; k < neqn; k++ )
+  sigma = ( tout - tn ) / h;
+  for ( i = 0; i < 9; i++ )
   {
-    ypout[k] = 0.0;
-    yout[k] = 0.0;
+    w1[i] = 0.0;
+    w2[i] = 0.0;
   }
-
-  for ( j = 1; j <= ki; j++ )
+  for ( g = 0; g < 5; g++ )
   {
-    i = ki + 1 - j;
-    for ( k = 0; k < neqn; k++ )
+    u = 0.5 * sigma * ( 1.0 + xi[g] );
+    for ( i = 0; i < 9; i++ )
     {
-      yout[k] = yout[k] + g[i-1] * phi[k+(i-1)*neqn];
-      ypout[k] = ypout[k] + rho[i-1] * phi[k+(i-1)*neqn];
+      li = 1.0;
+      for ( j = 0; j < 9; j++ )
+      {
+        if ( j != i )
+        {
+          li = li * ( u - ( j - 8 ) ) / ( i - j );
+        }
+      }
+      w1[i] = w1[i] + 0.5 * sigma * wi[g] * li;
+      w2[i] = w2[i] + 0.5 * sigma * wi[g] * ( sigma - u ) * li;
     }
   }
 
-  for ( k = 0; k < neqn; k++ )
+  for ( l = 0; l < d; l++ )
   {
-    yout[k] = y[k] + hi * yout[k];
+    y[l] = yn[l] + sigma * h * yn[d+l];
+    y[d+l] = yn[d+l];
+    for ( i = 0; i < 9; i++ )
+    {
+      y[l] = y[l] + h * h * w2[i] * acc[i*d+l];
+      y[d+l] = y[d+l] + h * w1[i] * acc[i*d+l];
+    }
   }
-  return;
+
+  c->t = tout;
+  c->iflag = 2;
+
+  return 2;
 }
 /******************************************************************************/
 
-void ode 
-( 
-  void f ( double t, double *y, double **yp ),
-  int neqn, 
-  double *y, 
-  double *t,
-  double tout,
-  double relerr,
-  double abserr,
-  int *iflag, 
-  double *work,
-  int *iwork 
-)
+void gj8_correct ( OdeContext *c, const double *y )
 
 /******************************************************************************/
 /*
   Purpose:
 
-    ODE is the user interface to an ordinary differential equation solver.
+    GJ8_CORRECT replaces the state of an ODE_GAUSS_JACKSON context.
+
+  Discussion:
+
+    GJ8 has its nodes on a fixed grid, so it is started again at C->T.
+    If the start does not converge, the old window is put back,
+    C->IFLAG is set to 6, and the context goes on from the state
+    before the correction.
+
+  Parameters:
+
+    Input, OdeContext *C, the context.
+
+    Input, double Y[NEQN], the new state at C->T.
+*/
+{
+  int l;
+  double *save;
+  int size;
+
+  size = ode_methods[ODE_GAUSS_JACKSON].work0 
+    + ode_methods[ODE_GAUSS_JACKSON].work2 * c->neqn / 2;
+  save = ( double * ) malloc ( size * sizeof ( double ) );
+  if ( save == NULL )
+  {
+    fprintf ( stderr, "\n" );
+    fprintf ( stderr, "GJ8_CORRECT - Fatal error!\n" );
+    fprintf ( stderr, "  Could not allocate the workspace.\n" );
+    exit ( 1 );
+  }
+  for ( l = 0; l < size; l++ )
+  {
+    save[l] = c->work[l];
+  }
+  if ( !gj8_start ( c, y ) )
+  {
+    for ( l = 0; l < size; l++ )
+    {
+      c->work[l] = save[l];
+    }
+    c->iflag = 6;
+  }
+  free ( save );
+
+  return;
+}
+/******************************************************************************/
+
+int gj8_start ( OdeContext *c, const double *y )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    GJ8_START starts the Gauss-Jackson method at C->T.
+
+  Discussion:
+
+    The window of nodes -4..4 is centred on C->T.  The states at the
+    other nodes are first taken from a Taylor series of order 2, and
+    the accelerations there improved by the corrector, with the sums
+    made to reproduce the state Y at node 0, until they change the
+    state by less than the tolerances.  The newest node is then node 4.
+
+  Parameters:
+
+    Input, OdeContext *C, the context, with the step in C->WORK[1].
+
+    Input, double Y[NEQN], the state at C->T.
+
+    Output, int GJ8_START, 1 if the iteration converged, 0 otherwise.
+*/
+{
+  double *acc;
+  double a0;
+  int conv;
+  int d;
+  double da;
+  double h;
+  int i;
+  int it;
+  int k;
+  int l;
+  double *s;
+  double s1;
+  double s2;
+  double *s1n;
+  double *yn;
+  double *yp;
+  double *yt;
+
+  d = c->neqn / 2;
+  h = c->work[1];
+  acc = c->work + 3;
+  s1n = acc + 9 * d;
+  s = s1n + d;
+  yn = s + d;
+  yt = yn + 2 * d;
+  yp = yt + 2 * d;
+
+  for ( l = 0; l < 2 * d; l++ )
+  {
+    yn[l] = y[l];
+  }
+  fcn ( c->f, c->t, yn, yp, c->neqn );
+  for ( l = 0; l < d; l++ )
+  {
+    acc[4*d+l] = yp[d+l];
+  }
+
+  for ( k = -4; k <= 4; k++ )
+  {
+    if ( k == 0 )
+    {
+      continue;
+    }
+    for ( l = 0; l < d; l++ )
+    {
+      a0 = acc[4*d+l];
+      yt[l] = yn[l] + k * h * yn[d+l] + 0.5 * k * k * h * h * a0;
+      yt[d+l] = yn[d+l] + k * h * a0;
+    }
+    fcn ( c->f, c->t + k * h, yt, yp, c->neqn );
+    for ( l = 0; l < d; l++ )
+    {
+      acc[(k+4)*d+l] = yp[d+l];
+    }
+  }
+
+  for ( it = 0; it < 50; it++ )
+  {
+    conv = 1;
+    for ( k = -4; k <= 4; k++ )
+    {
+      if ( k == 0 )
+      {
+        continue;
+      }
+/*
+  State at node K from the sums at node 0.
+*/
+      for ( l = 0; l < d; l++ )
+      {
+        s1 = yn[d+l] / h;
+        s2 = yn[l] / ( h * h );
+        for ( i = 0; i < 9; i++ )
+        {
+          s1 = s1 - gj8_b[4][i] * acc[i*d+l] / 7257600.0;
+          s2 = s2 - gj8_a[4][i] * acc[i*d+l] / 159667200.0;
+        }
+        for ( i = 0; i < k; i++ )
+        {
+          s2 = s2 + s1 + 0.5 * acc[(i+4)*d+l];
+          s1 = s1 + 0.5 * ( acc[(i+4)*d+l] + acc[(i+5)*d+l] );
+        }
+        for ( i = 0; k < i; i-- )
+        {
+          s1 = s1 - 0.5 * ( acc[(i+4)*d+l] + acc[(i+3)*d+l] );
+          s2 = s2 - s1 - 0.5 * acc[(i+3)*d+l];
+        }
+        for ( i = 0; i < 9; i++ )
+        {
+          s1 = s1 + gj8_b[k+4][i] * acc[i*d+l] / 7257600.0;
+          s2 = s2 + gj8_a[k+4][i] * acc[i*d+l] / 159667200.0;
+        }
+        yt[l] = h * h * s2;
+        yt[d+l] = h * s1;
+      }
+
+      fcn ( c->f, c->t + k * h, yt, yp, c->neqn );
+      for ( l = 0; l < d; l++ )
+      {
+        da = r8_abs ( yp[d+l] - acc[(k+4)*d+l] );
+        if ( c->relerr * r8_abs ( yt[l] ) + c->abserr < da * h * h ||
+             c->relerr * r8_abs ( yt[d+l] ) + c->abserr < da * r8_abs ( h ) )
+        {
+          conv = 0;
+        }
+        acc[(k+4)*d+l] = yp[d+l];
+      }
+/*
+  Node 4 becomes the newest.
+*/
+      if ( k == 4 )
+      {
+        for ( l = 0; l < d; l++ )
+        {
+          yp[l] = yt[l];
+          yp[d+l] = yt[d+l];
+        }
+      }
+    }
+    if ( conv )
+    {
+      break;
+    }
+  }
+  if ( !conv )
+  {
+    return 0;
+  }
+/*
+  Sums at node 4.
+*/
+  for ( l = 0; l < d; l++ )
+  {
+    s1 = yn[d+l] / h;
+    s2 = yn[l] / ( h * h );
+    for ( i = 0; i < 9; i++ )
+    {
+      s1 = s1 - gj8_b[4][i] * acc[i*d+l] / 7257600.0;
+      s2 = s2 - gj8_a[4][i] * acc[i*d+l] / 159667200.0;
+    }
+    for ( i = 0; i < 4; i++ )
+    {
+      s2 = s2 + s1 + 0.5 * acc[(i+4)*d+l];
+      s1 = s1 + 0.5 * ( acc[(i+4)*d+l] + acc[(i+5)*d+l] );
+    }
+    s1n[l] = s1;
+    s[l] = s2;
+  }
+  for ( l = 0; l < 2 * d; l++ )
+  {
+    yn[l] = yp[l];
+  }
+
+  c->work[0] = c->t;
+  c->work[2] = 4.0;
+
+  return 1;
+}
+/******************************************************************************/
+
+void gj8_step ( OdeContext *c )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    GJ8_STEP takes one step of the Gauss-Jackson method.
+
+  Discussion:
+
+    Predict, evaluate, correct; the correction is repeated after a
+    new evaluation while it changes the state by more than the
+    tolerances, at most 10 times.
+
+  Parameters:
+
+    Input, OdeContext *C, the context, started by GJ8_START.
+*/
+{
+  double *acc;
+  int conv;
+  int d;
+  double h;
+  int i;
+  int it;
+  int l;
+  double r;
+  double *s;
+  double *s1n;
+  double s1;
+  double s2;
+  double t;
+  double v;
+  double *yn;
+  double *yp;
+  double *yt;
+
+  d = c->neqn / 2;
+  h = c->work[1];
+  acc = c->work + 3;
+  s1n = acc + 9 * d;
+  s = s1n + d;
+  yn = s + d;
+  yt = yn + 2 * d;
+  yp = yt + 2 * d;
+  t = c->work[0] + ( c->work[2] + 1.0 ) * h;
+/*
+  Prediction, and the second sum at the new node.
+*/
+  for ( l = 0; l < d; l++ )
+  {
+    s[l] = s[l] + s1n[l] + 0.5 * acc[8*d+l];
+    r = s[l];
+    v = s1n[l] + 0.5 * acc[8*d+l];
+    for ( i = 0; i < 9; i++ )
+    {
+      r = r + gj8_a[9][i] * acc[i*d+l] / 159667200.0;
+      v = v + gj8_b[9][i] * acc[i*d+l] / 7257600.0;
+    }
+    yt[l] = h * h * r;
+    yt[d+l] = h * v;
+  }
+  fcn ( c->f, t, yt, yp, c->neqn );
+
+  for ( i = 0; i < 8; i++ )
+  {
+    for ( l = 0; l < d; l++ )
+    {
+      acc[i*d+l] = acc[(i+1)*d+l];
+    }
+  }
+  for ( l = 0; l < d; l++ )
+  {
+    acc[8*d+l] = yp[d+l];
+  }
+/*
+  Correction.
+*/
+  for ( it = 0; it < 10; it++ )
+  {
+    conv = 1;
+    for ( l = 0; l < d; l++ )
+    {
+      s1 = s1n[l] + 0.5 * ( acc[7*d+l] + acc[8*d+l] );
+      s2 = s[l];
+      for ( i = 0; i < 9; i++ )
+      {
+        s1 = s1 + gj8_b[8][i] * acc[i*d+l] / 7257600.0;
+        s2 = s2 + gj8_a[8][i] * acc[i*d+l] / 159667200.0;
+      }
+      r = h * h * s2;
+      v = h * s1;
+      if ( c->relerr * r8_abs ( r ) + c->abserr < r8_abs ( r - yt[l] ) ||
+           c->relerr * r8_abs ( v ) + c->abserr < r8_abs ( v - yt[d+l] ) )
+      {
+        conv = 0;
+      }
+      yt[l] = r;
+      yt[d+l] = v;
+    }
+    if ( conv )
+    {
+      break;
+    }
+    fcn ( c->f, t, yt, yp, c->neqn );
+    for ( l = 0; l < d; l++ )
+    {
+      acc[8*d+l] = yp[d+l];
+    }
+  }
+
+  for ( l = 0; l < d; l++ )
+  {
+    s1n[l] = s1n[l] + 0.5 * ( acc[7*d+l] + acc[8*d+l] );
+    yn[l] = yt[l];
+    yn[d+l] = yt[d+l];
+  }
+  c->work[2] = c->work[2] + 1.0;
+  ode_stats_step ( h, 8, 1 );
+
+  return;
+}
+/******************************************************************************/
+
+int i4_sign ( int i )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    I4_SIGN returns the sign of an I4.
+
+  Licensing:
+
+    This code is distributed under the GNU LGPL license.
+
+  Modified:
+
+    23 October 2007
+
+  Author:
+
+    John Burkardt
+
+  Parameters:
+
+    Input, int I, the integer whose sign is desired.
+
+    Output, int I4_SIGN, the sign of I.
+*/
+{
+  int value;
+
+  if ( i < 0 )
+  {
+    value = -1;
+  }
+  else
+  {
+    value = 1;
+  }
+  return value;
+}
+/******************************************************************************/
+
+void intrp 
+( 
+  double x,
+  double *y,
+  double xout,
+  double *yout,
+  double *ypout, 
+  int neqn,
+  int kold,
+  double *phi,
+  double *psi 
+)
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    INTRP approximates the solution at XOUT by polynomial interpolation.
+
+  Discussion:
+
+    The methods in STEP approximate the solution near X by a polynomial.
+    This routine approximates the solution at XOUT by evaluating the
+    polynomial there.  Information defining this polynomial is passed
+    from STEP, so INTRP cannot be used alone.
+
+  Licensing:
+
+    This code is distributed under the GNU LGPL license.
+
+  Modified:
+
+    01 February 2012
+
+  Author:
+
+    Original FORTRAN77 version by Lawrence Shampine, Marilyn Gordon.
+    C version by John Burkardt.
+
+  Reference:
+
+    Lawrence Shampine, Marilyn Gordon,
+    Computer Solution of Ordinary Differential Equations:
+    The Initial Value Problem,
+    Freeman, 1975,
+    ISBN: 0716704617,
+    LC: QA372.S416.
+
+  Parameters:
+
+    Input, double X, the point where the solution has been computed.
+
+    Input, double Y[NEQN], the computed solution at X.
+
+    Input, double XOUT, the point at which the solution is desired.
+
+    Output, double YOUT[NEQN], the solution at XOUT.
+
+    Output, double YPOUT[NEQN], the derivative of the solution
+    at XOUT.
+
+    Input, int NEQN, the number of equations.
+
+    Input, int KOLD, the order used for the last
+    successful step.
+
+    Input, double PHI[NEQN*16], contains information about the
+    interpolating polynomial.
+
+    Input, double PSI[12], contains information about the
+    interpolating polynomial.
+*/
+{
+  double eta;
+  double g[13];
+  double gamma;
+  double hi;
+  int i;
+  int j;
+  int k;
+  int ki;
+  double psijm1;
+  double rho[13];
+  double term;
+  double w[13];
+
+  hi = xout - x;
+  ki = kold + 1;
+/*
+  Initialize W for computing G.
+*/
+  for ( i = 1; i <= ki; i++ )
+  {
+    w[i-1] = 1.0 / ( double ) ( i );
+  }
+/*
+  Compute G.
+*/
+  g[0] = 1.0;
+  rho[0] = 1.0;
+  term = 0.0;
+
+  for ( j = 2; j <= ki; j++ )
+  {
+    psijm1 = psi[j-2];
+    gamma = ( hi + term ) / psijm1;
+    eta = hi / psijm1;
+    for ( i = 1; i <= ki + 1 - j; i++ )
+    {
+      w[i-1] = gamma * w[i-1] - eta * w[i];
+    }
+    g[j-1] = w[0];
+    rho[j-1] = gamma * rho[j-2];
+    term = psijm1;
+  }
+/*
+  Interpolate.
+*/
+  for ( k = 0; k < neqn; k++ )
+  {
+    ypout[k] = 0.0;
+    yout[k] = 0.0;
+  }
+
+  for ( j = 1; j <= ki; j++ )
+  {
+    i = ki + 1 - j;
+    for ( k = 0; k < neqn; k++ )
+    {
+      yout[k] = yout[k] + g[i-1] * phi[k+(i-1)*neqn];
+      ypout[k] = ypout[k] + rho[i-1] * phi[k+(i-1)*neqn];
+    }
+  }
+
+  for ( k = 0; k < neqn; k++ )
+  {
+    yout[k] = y[k] + hi * yout[k];
+  }
+  return;
+}
+/******************************************************************************/
+
+void ode 
+( 
+  void f ( double t, double *y, double **yp ),
+  int neqn, 
+  double *y, 
+  double *t,
+  double tout,
+  double relerr,
+  double abserr,
+  int *iflag, 
+  double *work,
+  int *iwork 
+)
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    ODE is the user interface to an ordinary differential equation solver.
 
   Discussion:
 
@@ -648,219 +2103,859 @@ void ode
     parameters in the call list are set for continuing the integration.
     The user has only to define a new value TOUT and call ODE again.
 
-    The differential equations are actually solved by a suite of codes
-    DE, STEP, and INTRP.  ODE allocates virtual storage in the
-    arrays WORK and IWORK and calls DE.  DE is a supervisor which
-    directs the solution.  It calls the routines STEP and INTRP
-    to advance the integration and to interpolate at output points.
+    The differential equations are actually solved by a suite of codes
+    DE, STEP, and INTRP.  ODE allocates virtual storage in the
+    arrays WORK and IWORK and calls DE.  DE is a supervisor which
+    directs the solution.  It calls the routines STEP and INTRP
+    to advance the integration and to interpolate at output points.
+
+    STEP uses a modified divided difference form of the Adams PECE
+    formulas and local extrapolation.  It adjusts the order and step
+    size to control the local error per unit step in a generalized
+    sense.  Normally each call to STEP advances the solution one step
+    in the direction of TOUT.  For reasons of efficiency, DE integrates
+    beyond TOUT internally, though never beyond T+10*(TOUT-T), and
+    calls INTRP to interpolate the solution at TOUT.  An option is
+    provided to stop the integration at TOUT but it should be used
+    only if it is impossible to continue the integration beyond TOUT.
+
+    On the first call to ODE, the user must provide storage in the calling
+    program for the arrays in the call list,
+      Y(NEQN), WORK(100+21*NEQN), IWORK(5),
+    declare F in an external statement, supply the double precision
+      SUBROUTINE F ( T, Y, YP )
+    to evaluate dy(i)/dt = yp(i) = f(t,y(1),y(2),...,y(neqn))
+    and initialize the parameters:
+    * NEQN, the number of equations to be integrated;
+    * Y(1:NEQN), the vector of initial conditions;
+    * T, the starting point of integration;
+    * TOUT, the point at which a solution is desired;
+    * RELERR, ABSERR, the relative and absolute local error tolerances;
+    * IFLAG, an indicator to initialize the code.  Normal input
+      is +1.  The user should set IFLAG = -1 only if it is
+      impossible to continue the integration beyond TOUT.
+    All parameters except F, NEQN and TOUT may be altered by the
+    code on output, and so must be variables in the calling program.
+
+    On normal return from ODE, IFLAG is 2, indicating that T has been
+    set to TOUT, and Y has been set to the approximate solution at TOUT.
+
+    If IFLAG is 3, then the program noticed that RELERR or ABSERR was
+    too small; the output values of these variables are more appropriate,
+    and integration can be resumed by setting IFLAG to 1.
+
+    IFLAG is -2 if the user input IFLAG = -1, and the code was able to
+    reach TOUT exactly.  In that case, the output value of T is TOUT,
+    and the output value of Y is the solution at TOUT, which was computed
+    directly, and not by interpolation.
+
+    Other values of IFLAG generally indicate an error.
+
+    Normally, it is desirable to compute many points along the solution
+    curve.  After the first successful step, more steps may be taken
+    simply by updating the value of TOUT and calling ODE again.
+
+  Licensing:
+
+    This code is distributed under the GNU LGPL license.
+
+  Modified:
+
+    01 February 2012
+
+  Author:
+
+    Original FORTRAN77 version by Lawrence Shampine, Marilyn Gordon.
+    C version by John Burkardt.
+
+  Reference:
+
+    Lawrence Shampine, Marilyn Gordon,
+    Computer Solution of Ordinary Differential Equations:
+    The Initial Value Problem,
+    Freeman, 1975,
+    ISBN: 0716704617,
+    LC: QA372.S416.
+
+  Parameters:
+
+    Input, void F ( double T, double *Y, double **YP ), the user-supplied function
+    which accepts input values T and Y[], evaluates the right hand
+    sides of the ODE, and stores the result in YP[].
+
+    Input, int NEQN, the number of equations.
+
+    Input/output, double Y[NEQN], the current solution.
+
+    Input/output, double *T, the current value of the independent
+    variable.
+
+    Input, double TOUT, the desired value of T on output.
+
+    Input, double RELERR, ABSERR, the relative and absolute error
+    tolerances.  At each step, the code requires
+      abs ( local error ) <= abs ( y ) * relerr + abserr
+    for each component of the local error and solution vectors.
+
+    Input/output, int *IFLAG, indicates the status of integration.
+    On input, IFLAG is normally 1 (or -1 in the special case where TOUT is
+    not to be exceeded.)  On normal output, IFLAG is 2.  Other output values
+    are:
+    * 3, integration did not reach TOUT because the error tolerances
+      were too small.  But RELERR and ABSERR were increased appropriately
+      for continuing;
+    * 4, integration did not reach TOUT because more than 500 steps were taken;
+    * 5, integration did not reach TOUT because the equations appear to
+      be stiff;
+    * 6, invalid input parameters (fatal error).
+    The value of IFLAG is returned negative when the input value is
+    negative and the integration does not reach TOUT.
+
+    Input/output, double WORK[100+21*NEQN], workspace.
+
+    Input/output, int IWORK[5], workspace.
+*/
+{
+  const int ialpha = 1;
+  const int ibeta = 13;
+  const int idelsn = 93;
+  const int ig = 62;
+  const int ih = 89;
+  const int ihold = 90;
+  int ip;
+  const int iphase = 75;
+  int iphi;
+  const int ipsi = 76;
+  const int isig = 25;
+  const int istart = 91;
+  const int itold = 92;
+  const int iv = 38;
+  const int iw = 50;
+  int iwt;
+  const int ix = 88;
+  int iyp;
+  int iypout;
+  const int iyy = 100;
+  int nornd;
+  int phase1;
+  int start;
+
+  iwt = iyy + neqn;
+  ip = iwt + neqn;
+  iyp = ip + neqn;
+  iypout = iyp + neqn;
+  iphi = iypout + neqn;
+
+  if ( abs ( *iflag ) != 1 )
+  {
+    start = ( 0.0 < work[istart-1] );
+    phase1 = ( 0.0 < work[iphase-1] );
+    nornd = ( iwork[1] != -1 );
+  }
+	
+  de 
+  (
+    f,
+    neqn,
+    y,
+    t,
+    tout,
+    relerr,
+    abserr,
+    iflag,
+    work+iyy-1, 
+    work+iwt-1,
+    work+ip-1,
+    work+iyp-1,
+    work+iypout-1,
+    work+iphi-1, 
+    work+ialpha-1,
+    work+ibeta-1,
+    work+isig-1,
+    work+iv-1,
+    work+iw-1,
+    work+ig-1, 
+    &phase1,
+    work+ipsi-1,
+    work+ix-1,
+    work+ih-1,
+    work+ihold-1,
+    &start, 
+    work+itold-1,
+    work+idelsn-1,
+    iwork+0,
+    &nornd,
+    iwork+2,
+    iwork+3, 
+    iwork+4
+  );
+
+  if ( start )
+  {
+    work[istart-1] = 1.0;
+  }
+  else
+  {
+    work[istart-1] = -1.0;
+  }
+
+  if ( phase1 )
+  {
+    work[iphase-1] = 1.0;
+  }
+  else
+  {
+    work[iphase-1] = -1.0;
+  }
+
+  if ( nornd )
+  {
+    iwork[1] = 1;
+  }
+  else
+  {
+    iwork[1] = -1;
+  }
+  return;
+}
+/******************************************************************************/
+
+int ode_advance ( OdeContext *c, double *y, double tout )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    ODE_ADVANCE integrates a context to TOUT and keeps it warm.
+
+  Discussion:
+
+    The step is the entry ADVANCE of the method of the context:
+    ADAMS_ADVANCE, DOP853 or GJ8.
+
+  Parameters:
+
+    Input, OdeContext *C, the context.
+
+    Input/output, double Y[NEQN], the state.  Input only on the first
+    call after ODE_START.
+
+    Input, double TOUT, the desired value of T on output.
+
+    Output, int ODE_ADVANCE, the status, as IFLAG of ODE.
+*/
+{
+  int iflag;
+  OdeStats *old;
+  double t0;
+
+  if ( c->t == tout )
+  {
+    return 2;
+  }
+
+  old = ode_stats_current;
+  ode_stats_current = &c->stats;
+  t0 = ode_clock ( );
+
+  iflag = ode_methods[c->method].advance ( c, y, tout );
+
+  c->stats.time = c->stats.time + ode_clock ( ) - t0;
+  ode_stats_current = old;
+
+  return iflag;
+}
+/******************************************************************************/
+
+int ode_arc ( OdeContext *c, double *y, double tout, OdeArc *a )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    ODE_ARC integrates a context to TOUT, recording every step.
+
+  Discussion:
+
+    The arc is the entry ARC of the method of the context; only
+    ODE_ADAMS has one, ADAMS_ARC.
+
+  Parameters:
+
+    Input, OdeContext *C, the context.
+
+    Input/output, double Y[NEQN], the state.  Input only on the first
+    call after ODE_START.
+
+    Input, double TOUT, the end of the arc.
+
+    Input/output, OdeArc *A, the arc.
+
+    Output, int ODE_ARC, the status: 2 on success, 3 if the
+    tolerances were increased on the way to TOUT.
+*/
+{
+  int iflag;
+  OdeStats *old;
+  double t0;
+
+  if ( ode_methods[c->method].arc == NULL )
+  {
+    fprintf ( stderr, "\n" );
+    fprintf ( stderr, "ODE_ARC - Fatal error!\n" );
+    fprintf ( stderr, "  The context is not ODE_ADAMS.\n" );
+    exit ( 1 );
+  }
+
+  if ( c->t == tout )
+  {
+    return 2;
+  }
+
+  old = ode_stats_current;
+  ode_stats_current = &c->stats;
+  t0 = ode_clock ( );
+
+  iflag = ode_methods[c->method].arc ( c, y, tout, a );
+
+  c->stats.time = c->stats.time + ode_clock ( ) - t0;
+  ode_stats_current = old;
+
+  return iflag;
+}
+/******************************************************************************/
+
+OdeArc *ode_arc_create ( int neqn )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    ODE_ARC_CREATE creates an empty arc.
+
+  Parameters:
+
+    Input, int NEQN, the number of equations.
+
+    Output, OdeArc *ODE_ARC_CREATE, the arc.
+*/
+{
+  OdeArc *a;
+
+  a = ( OdeArc * ) calloc ( 1, sizeof ( OdeArc ) );
+  if ( a != NULL )
+  {
+    a->yp = ( double * ) calloc ( neqn, sizeof ( double ) );
+  }
+  if ( a == NULL || a->yp == NULL )
+  {
+    fprintf ( stderr, "\n" );
+    fprintf ( stderr, "ODE_ARC_CREATE - Fatal error!\n" );
+    fprintf ( stderr, "  Could not allocate the arc.\n" );
+    exit ( 1 );
+  }
+  a->neqn = neqn;
+
+  return a;
+}
+/******************************************************************************/
+
+void ode_arc_eval ( OdeArc *a, double t, double *y, double *yp )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    ODE_ARC_EVAL evaluates the solution within an arc.
+
+  Discussion:
+
+    The step covering T is found by bisection over the ends of the
+    steps, which are monotonic, and its polynomial evaluated by INTRP.
+
+  Parameters:
+
+    Input, OdeArc *A, the arc.
+
+    Input, double T, the value of the independent variable.
+
+    Output, double Y[NEQN], the solution at T.
+
+    Output, double YP[NEQN], the derivative at T, or NULL.
+*/
+{
+  int hi;
+  int lo;
+  int mid;
+  double sgn;
+/*
+  An empty arc has no polynomial to evaluate.
+*/
+  if ( a->n < 1 )
+  {
+    printf ( "ode_arc_eval: error\n" );
+    exit ( EXIT_FAILURE );
+  }
+/*
+  First step whose end is at or beyond T.
+*/
+  sgn = 1.0;
+  if ( 1 < a->n && a->x[a->n-1] < a->x[0] )
+  {
+    sgn = -1.0;
+  }
+  lo = 0;
+  hi = a->n - 1;
+  while ( lo < hi )
+  {
+    mid = ( lo + hi ) / 2;
+    if ( ( a->x[mid] - t ) * sgn < 0.0 )
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+
+  intrp ( a->x[lo], a->y + lo * a->neqn, t, y, ( yp != NULL ) ? yp : a->yp, 
+    a->neqn, a->k[lo], a->phi + lo * 13 * a->neqn, a->psi + lo * 12 );
+  return;
+}
+/******************************************************************************/
+
+void ode_arc_free ( OdeArc *a )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    ODE_ARC_FREE releases an arc.
+
+  Parameters:
+
+    Input, OdeArc *A, the arc.
+*/
+{
+  free ( a->x );
+  free ( a->k );
+  free ( a->y );
+  free ( a->phi );
+  free ( a->psi );
+  free ( a->yp );
+  free ( a );
+  return;
+}
+/******************************************************************************/
+
+void ode_arc_push ( OdeArc *a, double x, double *y, int k, double *phi,
+  double *psi )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    ODE_ARC_PUSH adds a step to an arc, doubling its capacity when full.
+
+  Parameters:
+
+    Input/output, OdeArc *A, the arc.
+
+    Input, double X, the end of the step.
+
+    Input, double Y[NEQN], the solution at X.
+
+    Input, int K, the order of the step.
+
+    Input, double PHI[NEQN*16], PSI[12], the difference table.
+*/
+{
+  int l;
+  int neqn;
+  int size;
+
+  neqn = a->neqn;
+
+  if ( a->n == a->size )
+  {
+    size = ( a->size == 0 ) ? 64 : 2 * a->size;
+    a->x = ( double * ) realloc ( a->x, size * sizeof ( double ) );
+    a->k = ( int * ) realloc ( a->k, size * sizeof ( int ) );
+    a->y = ( double * ) realloc ( a->y, ( size_t ) size * neqn * sizeof ( double ) );
+    a->phi = ( double * ) realloc ( a->phi, ( size_t ) size * 13 * neqn * sizeof ( double ) );
+    a->psi = ( double * ) realloc ( a->psi, size * 12 * sizeof ( double ) );
+    if ( a->x == NULL || a->k == NULL || a->y == NULL || a->phi == NULL || 
+      a->psi == NULL )
+    {
+      fprintf ( stderr, "\n" );
+      fprintf ( stderr, "ODE_ARC_PUSH - Fatal error!\n" );
+      fprintf ( stderr, "  Could not allocate the arc.\n" );
+      exit ( 1 );
+    }
+    a->size = size;
+  }
+
+  a->x[a->n] = x;
+  a->k[a->n] = k;
+  for ( l = 0; l < neqn; l++ )
+  {
+    a->y[a->n*neqn+l] = y[l];
+  }
+  for ( l = 0; l < 13 * neqn; l++ )
+  {
+    a->phi[( size_t ) a->n*13*neqn+l] = phi[l];
+  }
+  for ( l = 0; l < 12; l++ )
+  {
+    a->psi[a->n*12+l] = psi[l];
+  }
+  a->n = a->n + 1;
+  return;
+}
+/******************************************************************************/
+
+double ode_clock ( void )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    ODE_CLOCK returns the wall clock time, for the statistics.
+
+  Discussion:
+
+    Where there is no monotonic POSIX clock, the processor time of
+    CLOCK is returned instead.
+
+  Parameters:
+
+    Output, double ODE_CLOCK, the time in seconds from an arbitrary origin.
+*/
+{
+# ifdef CLOCK_MONOTONIC
+  struct timespec ts;
+
+  clock_gettime ( CLOCK_MONOTONIC, &ts );
+
+  return ( double ) ts.tv_sec + 1.0E-09 * ( double ) ts.tv_nsec;
+# else
+  return ( double ) clock ( ) / ( double ) CLOCKS_PER_SEC;
+# endif
+}
+/******************************************************************************/
+
+void ode_correct ( OdeContext *c, const double *y )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    ODE_CORRECT replaces the state of a context, keeping its history.
+
+  Discussion:
+
+    The replacement is the entry CORRECT of the method of the context:
+    ADAMS_CORRECT, DOP853_CORRECT or GJ8_CORRECT.
+
+  Parameters:
+
+    Input, OdeContext *C, the context.
+
+    Input, double Y[NEQN], the new state at C->T.
+*/
+{
+  OdeStats *old;
+  double t0;
+
+  if ( c->iflag == 1 )
+  {
+    return;
+  }
+
+  old = ode_stats_current;
+  ode_stats_current = &c->stats;
+  t0 = ode_clock ( );
+
+  ode_methods[c->method].correct ( c, y );
+
+  c->stats.time = c->stats.time + ode_clock ( ) - t0;
+  ode_stats_current = old;
+
+  return;
+}
+/******************************************************************************/
+
+OdeContext *ode_create ( void f ( double t, double *y, double **yp ), int neqn,
+  double relerr, double abserr )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    ODE_CREATE creates an integrator context.
+
+  Parameters:
+
+    Input, void F ( double T, double *Y, double **YP ), the right hand
+    sides, as for ODE.
+
+    Input, int NEQN, the number of equations.
+
+    Input, double RELERR, ABSERR, the relative and absolute error
+    tolerances.
+
+    Output, OdeContext *ODE_CREATE, the context.
+*/
+{
+  OdeContext *c;
+
+  if ( neqn < 1 )
+  {
+    fprintf ( stderr, "\n" );
+    fprintf ( stderr, "ODE_CREATE - Fatal error!\n" );
+    fprintf ( stderr, "  NEQN < 1.\n" );
+    exit ( 1 );
+  }
+
+  c = ( OdeContext * ) calloc ( 1, sizeof ( OdeContext ) );
+  if ( c != NULL )
+  {
+    c->work = ( double * ) calloc ( ode_methods[ODE_ADAMS].work0 
+      + ode_methods[ODE_ADAMS].work2 * neqn / 2, sizeof ( double ) );
+  }
+  if ( c == NULL || c->work == NULL )
+  {
+    fprintf ( stderr, "\n" );
+    fprintf ( stderr, "ODE_CREATE - Fatal error!\n" );
+    fprintf ( stderr, "  Could not allocate the workspace.\n" );
+    exit ( 1 );
+  }
+
+  c->f = f;
+  c->neqn = neqn;
+  c->method = ODE_ADAMS;
+  c->relerr = relerr;
+  c->abserr = abserr;
+  c->t = 0.0;
+  c->iflag = 1;
+
+  return c;
+}
+/******************************************************************************/
+
+void ode_free ( OdeContext *c )
+
+/******************************************************************************/
+/*
+  Purpose:
 
-    STEP uses a modified divided difference form of the Adams PECE
-    formulas and local extrapolation.  It adjusts the order and step
-    size to control the local error per unit step in a generalized
-    sense.  Normally each call to STEP advances the solution one step
-    in the direction of TOUT.  For reasons of efficiency, DE integrates
-    beyond TOUT internally, though never beyond T+10*(TOUT-T), and
-    calls INTRP to interpolate the solution at TOUT.  An option is
-    provided to stop the integration at TOUT but it should be used
-    only if it is impossible to continue the integration beyond TOUT.
+    ODE_FREE releases an integrator context.
 
-    On the first call to ODE, the user must provide storage in the calling
-    program for the arrays in the call list,
-      Y(NEQN), WORK(100+21*NEQN), IWORK(5),
-    declare F in an external statement, supply the double precision
-      SUBROUTINE F ( T, Y, YP )
-    to evaluate dy(i)/dt = yp(i) = f(t,y(1),y(2),...,y(neqn))
-    and initialize the parameters:
-    * NEQN, the number of equations to be integrated;
-    * Y(1:NEQN), the vector of initial conditions;
-    * T, the starting point of integration;
-    * TOUT, the point at which a solution is desired;
-    * RELERR, ABSERR, the relative and absolute local error tolerances;
-    * IFLAG, an indicator to initialize the code.  Normal input
-      is +1.  The user should set IFLAG = -1 only if it is
-      impossible to continue the integration beyond TOUT.
-    All parameters except F, NEQN and TOUT may be altered by the
-    code on output, and so must be variables in the calling program.
+  Parameters:
 
-    On normal return from ODE, IFLAG is 2, indicating that T has been
-    set to TOUT, and Y has been set to the approximate solution at TOUT.
+    Input, OdeContext *C, the context.
+*/
+{
+  free ( c->work );
+  free ( c );
+  return;
+}
+/******************************************************************************/
 
-    If IFLAG is 3, then the program noticed that RELERR or ABSERR was
-    too small; the output values of these variables are more appropriate,
-    and integration can be resumed by setting IFLAG to 1.
+int ode_method ( OdeContext *c, int method )
 
-    IFLAG is -2 if the user input IFLAG = -1, and the code was able to
-    reach TOUT exactly.  In that case, the output value of T is TOUT,
-    and the output value of Y is the solution at TOUT, which was computed
-    directly, and not by interpolation.
+/******************************************************************************/
+/*
+  Purpose:
 
-    Other values of IFLAG generally indicate an error.
+    ODE_METHOD selects the integration method of a context.
 
-    Normally, it is desirable to compute many points along the solution
-    curve.  After the first successful step, more steps may be taken
-    simply by updating the value of TOUT and calling ODE again.
+  Discussion:
 
-  Licensing:
+    The workspace is allocated for the method and the context is set
+    for a cold start at C->T.
 
-    This code is distributed under the GNU LGPL license.
+  Parameters:
 
-  Modified:
+    Input, OdeContext *C, the context.
 
-    01 February 2012
+    Input, int METHOD, ODE_ADAMS, ODE_DOP853 or ODE_GAUSS_JACKSON.
 
-  Author:
+    Output, int ODE_METHOD, the previous method.
+*/
+{
+  int old;
+  int size;
 
-    Original FORTRAN77 version by Lawrence Shampine, Marilyn Gordon.
-    C version by John Burkardt.
+  if ( method < 0 || ODE_METHODS <= method || 
+    ( ode_methods[method].even && c->neqn % 2 != 0 ) )
+  {
+    fprintf ( stderr, "\n" );
+    fprintf ( stderr, "ODE_METHOD - Fatal error!\n" );
+    fprintf ( stderr, "  Unknown method, or odd NEQN for ODE_GAUSS_JACKSON.\n" );
+    exit ( 1 );
+  }
 
-  Reference:
+  size = ode_methods[method].work0 + ode_methods[method].work2 * c->neqn / 2;
+  free ( c->work );
+  c->work = ( double * ) calloc ( size, sizeof ( double ) );
+  if ( c->work == NULL )
+  {
+    fprintf ( stderr, "\n" );
+    fprintf ( stderr, "ODE_METHOD - Fatal error!\n" );
+    fprintf ( stderr, "  Could not allocate the workspace.\n" );
+    exit ( 1 );
+  }
 
-    Lawrence Shampine, Marilyn Gordon,
-    Computer Solution of Ordinary Differential Equations:
-    The Initial Value Problem,
-    Freeman, 1975,
-    ISBN: 0716704617,
-    LC: QA372.S416.
+  old = c->method;
+  c->method = method;
+  c->iflag = 1;
+
+  return old;
+}
+/******************************************************************************/
+
+void ode_start ( OdeContext *c, double t )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    ODE_START sets a context for a cold start at T.
 
   Parameters:
 
-    Input, void F ( double T, double *Y, double **YP ), the user-supplied function
-    which accepts input values T and Y[], evaluates the right hand
-    sides of the ODE, and stores the result in YP[].
+    Input, OdeContext *C, the context.
 
-    Input, int NEQN, the number of equations.
+    Input, double T, the initial value of the independent variable.
+*/
+{
+  c->t = t;
+  c->iflag = 1;
+  return;
+}
+/******************************************************************************/
 
-    Input/output, double Y[NEQN], the current solution.
+void ode_stats_print ( const OdeStats *s )
 
-    Input/output, double *T, the current value of the independent
-    variable.
+/******************************************************************************/
+/*
+  Purpose:
 
-    Input, double TOUT, the desired value of T on output.
+    ODE_STATS_PRINT prints the statistics of a context.
 
-    Input, double RELERR, ABSERR, the relative and absolute error
-    tolerances.  At each step, the code requires
-      abs ( local error ) <= abs ( y ) * relerr + abserr
-    for each component of the local error and solution vectors.
+  Discussion:
 
-    Input/output, int *IFLAG, indicates the status of integration.
-    On input, IFLAG is normally 1 (or -1 in the special case where TOUT is
-    not to be exceeded.)  On normal output, IFLAG is 2.  Other output values
-    are:
-    * 3, integration did not reach TOUT because the error tolerances
-      were too small.  But RELERR and ABSERR were increased appropriately
-      for continuing;
-    * 4, integration did not reach TOUT because more than 500 steps were taken;
-    * 5, integration did not reach TOUT because the equations appear to
-      be stiff;
-    * 6, invalid input parameters (fatal error).
-    The value of IFLAG is returned negative when the input value is
-    negative and the integration does not reach TOUT.
+    One line of totals, then the steps per order and per step size
+    bin, the empty ones left out.  A bin is labelled by its lower end.
 
-    Input/output, double WORK[100+21*NEQN], workspace.
+  Parameters:
 
-    Input/output, int IWORK[5], workspace.
+    Input, const OdeStats *S, the statistics.
 */
 {
-  const int ialpha = 1;
-  const int ibeta = 13;
-  const int idelsn = 93;
-  const int ig = 62;
-  const int ih = 89;
-  const int ihold = 90;
-  int ip;
-  const int iphase = 75;
-  int iphi;
-  const int ipsi = 76;
-  const int isig = 25;
-  const int istart = 91;
-  const int itold = 92;
-  const int iv = 38;
-  const int iw = 50;
-  int iwt;
-  const int ix = 88;
-  int iyp;
-  int iypout;
-  const int iyy = 100;
-  int nornd;
-  int phase1;
-  int start;
+  int i;
 
-  iwt = iyy + neqn;
-  ip = iwt + neqn;
-  iyp = ip + neqn;
-  iypout = iyp + neqn;
-  iphi = iypout + neqn;
+  printf ( "  evals %ld, steps %ld, rejected %ld, time %.3f ms, in f %.3f ms\n",
+    s->evals, s->steps, s->rejected, 1.0E+03 * s->time, 1.0E+03 * s->f_time );
 
-  if ( abs ( *iflag ) != 1 )
+  printf ( "  order" );
+  for ( i = 1; i <= ODE_STATS_ORDERS; i++ )
   {
-    start = ( 0.0 < work[istart-1] );
-    phase1 = ( 0.0 < work[iphase-1] );
-    nornd = ( iwork[1] != -1 );
+    if ( 0 < s->order[i] )
+    {
+      printf ( "  %d: %ld", i, s->order[i] );
+    }
   }
-	
-  de 
-  (
-    f,
-    neqn,
-    y,
-    t,
-    tout,
-    relerr,
-    abserr,
-    iflag,
-    work+iyy-1, 
-    work+iwt-1,
-    work+ip-1,
-    work+iyp-1,
-    work+iypout-1,
-    work+iphi-1, 
-    work+ialpha-1,
-    work+ibeta-1,
-    work+isig-1,
-    work+iv-1,
-    work+iw-1,
-    work+ig-1, 
-    &phase1,
-    work+ipsi-1,
-    work+ix-1,
-    work+ih-1,
-    work+ihold-1,
-    &start, 
-    work+itold-1,
-    work+idelsn-1,
-    iwork+0,
-    &nornd,
-    iwork+2,
-    iwork+3, 
-    iwork+4
-  );
+  printf ( "\n" );
 
-  if ( start )
+  printf ( "  h    " );
+  for ( i = 0; i < ODE_STATS_BINS; i++ )
   {
-    work[istart-1] = 1.0;
+    if ( 0 < s->step[i] )
+    {
+      printf ( "  %.3g: %ld", ldexp ( 1.0, i - 8 ), s->step[i] );
+    }
   }
-  else
+  printf ( "\n" );
+
+  return;
+}
+/******************************************************************************/
+
+void ode_stats_reset ( OdeContext *c )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    ODE_STATS_RESET clears the statistics of a context.
+
+  Parameters:
+
+    Input, OdeContext *C, the context.
+*/
+{
+  OdeStats zero = { 0 };
+
+  c->stats = zero;
+  return;
+}
+/******************************************************************************/
+
+void ode_stats_step ( double h, int k, int accepted )
+
+/******************************************************************************/
+/*
+  Purpose:
+
+    ODE_STATS_STEP counts a step in the statistics of the context being integrated.
+
+  Parameters:
+
+    Input, double H, the step size.
+
+    Input, int K, the order.
+
+    Input, int ACCEPTED, 1 for an accepted step, 0 for a rejected one.
+*/
+{
+  int e;
+  int i;
+
+  if ( ode_stats_current == NULL )
   {
-    work[istart-1] = -1.0;
+    return;
   }
 
-  if ( phase1 )
+  if ( !accepted )
   {
-    work[iphase-1] = 1.0;
+    ode_stats_current->rejected = ode_stats_current->rejected + 1;
+    return;
   }
-  else
+/*
+  2**(E-1) <= |H| < 2**E falls in bin E+7.
+*/
+  frexp ( h, &e );
+  i = e + 7;
+  if ( i < 0 )
   {
-    work[iphase-1] = -1.0;
+    i = 0;
   }
-
-  if ( nornd )
+  if ( ODE_STATS_BINS - 1 < i )
   {
-    iwork[1] = 1;
+    i = ODE_STATS_BINS - 1;
   }
-  else
+  if ( ODE_STATS_ORDERS < k )
   {
-    iwork[1] = -1;
+    k = ODE_STATS_ORDERS;
   }
+
+  ode_stats_current->steps = ode_stats_current->steps + 1;
+  ode_stats_current->order[k] = ode_stats_current->order[k] + 1;
+  ode_stats_current->step[i] = ode_stats_current->step[i] + 1;
+
   return;
 }
 /******************************************************************************/
@@ -1365,7 +3460,7 @@ void step
 */
   if ( *start )
   {
-    f ( *x, y, &yp );
+    fcn ( f, *x, y, yp, neqn );
     for ( l = 1; l <= neqn; l++ )
     {
       phi[l-1+0*neqn] = yp[l-1];
@@ -1546,7 +3641,7 @@ void step
     xold = *x;
     *x = *x + *h;
     absh = r8_abs ( *h );
-    f ( *x, p, &yp );
+    fcn ( f, *x, p, yp, neqn );
 /*
   Estimate the errors at orders K, K-1 and K-2.
 */
@@ -1632,6 +3727,7 @@ void step
 */
     ifail = ifail + 1;
     temp2 = 0.5;
+    ode_stats_step ( *h, *k, 0 );
 
     if ( 3 < ifail )
     {
@@ -1664,6 +3760,7 @@ void step
 */
   *kold = *k;
   *hold = *h;
+  ode_stats_step ( *h, *k, 1 );
 /*
   Correct and evaluate.
 */
@@ -1684,7 +3781,7 @@ void step
     }
   }
 
-  f ( *x, y, &yp );
+  fcn ( f, *x, y, yp, neqn );
 /*
   Update differences for the next step.
 */
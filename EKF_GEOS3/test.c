@@ -8,7 +8,10 @@
  */
 
 #include "includes/global.h"
+#include "includes/const.h"
 #include "includes/m_utils.h"
+#include "includes/m_fixed.h"
+#include "includes/arena.h"
 #include "includes/R_x.h"
 #include "includes/R_y.h"
 #include "includes/R_z.h"
@@ -45,13 +48,18 @@
 #include "includes/JPL_Eph_DE430.h"
 #include "includes/Accel.h"
 #include "includes/G_AccelHarmonic.h"
+#include "includes/Cunningham.h"
+#include "includes/GravGrid.h"
+#include "includes/GravModel.h"
 #include "includes/VarEqn.h"
 #include "includes/ode.h"
 #include "includes/rpoly.h"
 #include "includes/anglesg.h"
+#include "includes/EarthRot.h"
 
 #include <stdio.h>
 #include <math.h>
+#include <string.h>
 #include <float.h>
 #include <unistd.h>
 
@@ -101,6 +109,25 @@ int equals_matrix(double **A, double **B, int f, int c, double p) {
 	return equal;
 }
 
+/** @brief Comparator of a matrix of 3 rows and 3 columns with a Mat3.
+ *
+ *  @param [in] A First matrix.
+ *  @param [in] B Second matrix.
+ *  @return 0=error, 1=pass.
+ */
+int equals_mat3(double **A, Mat3 B, double p) {
+	int equal = 1;
+	
+    for(int i = 0; i < 3; i++)
+		for(int j = 0; j < 3; j++)
+			if(fabs(A[i][j]-B.m[i][j]) > p) {
+				printf("%2.20lf %2.20lf\n",A[i][j],B.m[i][j]);
+				equal = 0;
+			}
+	
+	return equal;
+}
+
 
 /** @brief Unit test for function v_sum.
  *
@@ -511,6 +538,170 @@ int trans_01() {
     return 0;
 }
 
+/** @brief Unit test for function v_axpy.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int v_axpy_01() {
+    int c = 3;
+	
+	double *v = v_create(c);
+	v[0] = 1; v[1] = 2; v[2] = 3;
+	
+	double *w = v_create(c);
+	w[0] = 5; w[1] = 1; w[2] = 4;
+	
+	double *x = v_create(c);
+	x[0] = 7; x[1] = 5; x[2] = 10;
+    
+	v_axpy(2.0,v,c,w,c);
+    _assert(equals_vector(w,x,c,1e-10));
+    
+	v_free(v,c);
+	v_free(w,c);
+	v_free(x,c);
+    
+    return 0;
+}
+
+/** @brief Unit test for function m_dot_into.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int m_dot_into_01() {
+    int f = 3;
+    int c = 4;
+	
+	double **A = m_create(f,c);
+	
+	A[0][0] = 0; A[0][1] = 2; A[0][2] = 8; A[0][3] = 0;
+	A[1][0] = 1; A[1][1] = -1; A[1][2] = 0; A[1][3] = 0;
+	A[2][0] = 0; A[2][1] = 1; A[2][2] = 0; A[2][3] = 5;
+	
+	double **B = m_create(c,f);
+	
+	B[0][0] = 2; B[0][1] = 0; B[0][2] = 0;
+	B[1][0] = 7; B[1][1] = -2; B[1][2] = 1;
+	B[2][0] = 0; B[2][1] = -3; B[2][2] = 0;
+	B[3][0] = 1; B[3][1] = 0; B[3][2] = 0;
+	
+	double **C = m_create(f,f);
+	
+	C[0][0] = 14; C[0][1] = -28; C[0][2] = 2;
+	C[1][0] = -5; C[1][1] = 2; C[1][2] = -1;
+	C[2][0] = 12; C[2][1] = -2; C[2][2] = 1;
+    
+	double R_data[9], *R[3];
+	m_wrap(R_data,R,f,f);
+	m_dot_into(A,f,c,B,c,f,R);
+    _assert(equals_matrix(R,C,f,f,1e-10));
+    
+	m_free(A,f,c);
+	m_free(B,c,f);
+	m_free(C,f,f);
+    
+    return 0;
+}
+
+/** @brief Unit test for function m_dot_trans_into.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int m_dot_trans_into_01() {
+    int f = 3;
+    int c = 4;
+	
+	double **A = m_create(f,c);
+	
+	A[0][0] = 0; A[0][1] = 2; A[0][2] = 8; A[0][3] = 0;
+	A[1][0] = 1; A[1][1] = -1; A[1][2] = 0; A[1][3] = 0;
+	A[2][0] = 0; A[2][1] = 1; A[2][2] = 0; A[2][3] = 5;
+	
+	double **B = m_create(f,c);
+	
+	B[0][0] = 2; B[0][1] = 7; B[0][2] = 0; B[0][3] = 1;
+	B[1][0] = 0; B[1][1] = -2; B[1][2] = -3; B[1][3] = 0;
+	B[2][0] = 0; B[2][1] = 1; B[2][2] = 0; B[2][3] = 0;
+	
+	double **C = m_create(f,f);
+	
+	C[0][0] = 14; C[0][1] = -28; C[0][2] = 2;
+	C[1][0] = -5; C[1][1] = 2; C[1][2] = -1;
+	C[2][0] = 12; C[2][1] = -2; C[2][2] = 1;
+    
+	double **R = m_create(f,f);
+	m_dot_trans_into(A,f,c,B,f,c,R);
+    _assert(equals_matrix(R,C,f,f,1e-10));
+    
+	m_free(A,f,c);
+	m_free(B,f,c);
+	m_free(C,f,f);
+	m_free(R,f,f);
+    
+    return 0;
+}
+
+/** @brief Unit test for the arena allocator.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int arena_01() {
+	double *h = v_create(3);
+	
+	Arena *a = arena_create(1024);
+	_assert(arena_bind(a) == NULL);
+	_assert(arena_current() == a);
+	
+	double *v = v_create(3);
+	_assert(arena_owns(a,v) && !arena_owns(a,h));
+	_assert(v[0] == 0 && v[1] == 0 && v[2] == 0);
+	
+	size_t mark = arena_mark(a);
+	double **A = m_zeros(4,4);
+	_assert(arena_owns(a,A) && arena_owns(a,A[3]));
+	A[3][3] = 1.0;
+	m_free(A,4,4);
+	v_free(h,3);
+	_assert(arena_peak(a) >= mark + 4*sizeof(double *) + 16*sizeof(double));
+	
+	arena_release(a,mark);
+	_assert(arena_mark(a) == mark);
+	double **B = m_zeros(4,4);
+	_assert(B == A && B[3][3] == 0.0);
+	
+	arena_reset(a);
+	_assert(arena_mark(a) == 0);
+	_assert(arena_bind(NULL) == a);
+	arena_free(a);
+	_assert(arena_current() == NULL);
+    
+    return 0;
+}
+
+/** @brief Unit test for function mem_totals.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int mem_totals_01() {
+	long allocs0, live0, allocs, live;
+	size_t bytes0, bytes;
+	
+	mem_totals(&allocs0,&live0,&bytes0);
+	double *v = v_create(4);
+	mem_totals(&allocs,&live,&bytes);
+#ifdef MEM_STATS
+	_assert(allocs == allocs0+1 && live == live0+1 && bytes == bytes0+4*sizeof(double));
+#else
+	_assert(allocs == 0 && live == 0 && bytes == 0);
+#endif
+	
+	v_free(v,4);
+	mem_totals(&allocs,&live,&bytes);
+	_assert(live == live0 && bytes == bytes0);
+    
+    return 0;
+}
+
 /** @brief Unit test for function R_x.
  *
  *  @return 0=error, 1=pass.
@@ -523,11 +714,10 @@ int R_x_01() {
 	A[1][0] = 0; A[1][1] = 0.54030230586814; A[1][2] = 0.841470984807897;
 	A[2][0] = 0; A[2][1] = -0.841470984807897; A[2][2] = 0.54030230586814;
     
-	double **R = R_x(1.0);
-    _assert(equals_matrix(A,R,n,n,1e-10));
+	Mat3 R = R_x(1.0);
+    _assert(equals_mat3(A,R,1e-10));
     
 	m_free(A,n,n);
-	m_free(R,n,n);
 	
     return 0;
 }
@@ -544,11 +734,10 @@ int R_y_01() {
 	A[1][0] = 0; A[1][1] = 1; A[1][2] = 0;
 	A[2][0] = 0.841470984807897; A[2][1] = 0; A[2][2] = 0.54030230586814;
     
-	double **R = R_y(1.0);
-    _assert(equals_matrix(A,R,n,n,1e-10));
+	Mat3 R = R_y(1.0);
+    _assert(equals_mat3(A,R,1e-10));
     
 	m_free(A,n,n);
-	m_free(R,n,n);
 	
     return 0;
 }
@@ -565,11 +754,10 @@ int R_z_01() {
 	A[1][0] = -0.841470984807897; A[1][1] = 0.54030230586814; A[1][2] = 0;
 	A[2][0] = 0; A[2][1] = 0; A[2][2] = 1;
     
-	double **R = R_z(1.0);
-    _assert(equals_matrix(A,R,n,n,1e-10));
+	Mat3 R = R_z(1.0);
+    _assert(equals_mat3(A,R,1e-10));
     
 	m_free(A,n,n);
-	m_free(R,n,n);
 	
     return 0;
 }
@@ -662,11 +850,10 @@ int NutMatrix_01() {
 	A[1][0] = 5.7165573326254723e-05; A[1][1] = 0.99999999774967985; A[1][2] = 3.511036246666723e-05;
 	A[2][0] = 2.4782683776004558e-05; A[2][1] = -3.511177922960697e-05; A[2][2] = 0.99999999907649073;
     
-	double **R = NutMatrix(49746.1097222222);
-    _assert(equals_matrix(A,R,n,n,1e-10));
+	Mat3 R = NutMatrix(49746.1097222222);
+    _assert(equals_mat3(A,R,1e-10));
     
 	m_free(A,n,n);
-	m_free(R,n,n);
 	
     return 0;
 }
@@ -678,13 +865,13 @@ int NutMatrix_01() {
 int AzElPa_01() {
     int n = 3;
 	
-	double *s = v_create(n), Az, El, *dAds, *dEds, Az_sol = 1.05892995381517,
+	double *s = v_create(n), Az, El, *dAds = v_create(n), *dEds = v_create(n), Az_sol = 1.05892995381517,
 			    El_sol = 0.286534142298292, *dAds_sol = v_create(n), *dEds_sol = v_create(n);
 	s[0] = 2159055.44810213; s[1] = 1212982.41102083; s[2] = 729669.130080208;
 	dAds_sol[0] = 1.97784562210396e-07; dAds_sol[1] = -3.52047839037887e-07; dAds_sol[2] = 0.0;
 	dEds_sol[0] = -9.54424040207182e-08; dEds_sol[1] = -5.36206503841483e-08; dEds_sol[2] = 3.71546961476313e-07;
     
-	AzElPa(s, &Az, &El, &dAds, &dEds);
+	AzElPa(s, &Az, &El, dAds, dEds);
     _assert(fabs(Az_sol - Az) < 1e-10 &&
     		fabs(El_sol - El) < 1e-10 &&
 			equals_vector(dAds_sol,dAds,n,1e-10) &&
@@ -711,11 +898,10 @@ int PoleMatrix_01() {
 	A[1][0] = 0.0; A[1][1] = 0.877582561890373; A[1][2] = -0.479425538604203;
 	A[2][0] = -0.29552020666134; A[2][1] = 0.458012710847292; A[2][2] = 0.838386643594204;
     
-	double **R = PoleMatrix(0.3,0.5);
-    _assert(equals_matrix(A,R,n,n,1e-10));
+	Mat3 R = PoleMatrix(0.3,0.5);
+    _assert(equals_mat3(A,R,1e-10));
     
 	m_free(A,n,n);
-	m_free(R,n,n);
 	
     return 0;
 }
@@ -732,11 +918,10 @@ int PrecMatrix_01() {
 	A[1][0] = -6.42297715142866e-05; A[1][1] = 0.999999997937268; A[1][2] = -8.97642805260184e-10;
 	A[2][0] = -2.79510023652174e-05; A[2][1] = -8.97643692455259e-10; A[2][2] = 0.999999999609371;
     
-	double **R = PrecMatrix(526,421);
-    _assert(equals_matrix(A,R,n,n,1e-10));
+	Mat3 R = PrecMatrix(526,421);
+    _assert(equals_mat3(A,R,1e-10));
     
 	m_free(A,n,n);
-	m_free(R,n,n);
 	
     return 0;
 }
@@ -891,6 +1076,46 @@ int Legendre_01() {
     return 0;
 }
 
+/** @brief Unit test for functions Legendre_eval and
+ *  Legendre_eval_nm.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int Legendre_eval_01() {
+	LegendreEngine *le = Legendre_create(4,2);
+	
+	double pnm_sol[6] = {1.0, 0.830389391308554, 1.52001758503058,
+						 -0.347097518865836, 1.62950155523887, 1.49139129468805};
+	double dpnm_sol[6] = {0.0, 1.52001758503058, -0.830389391308554,
+						  2.82237948468622, 2.09258183254477, -1.62950155523887};
+	
+	Legendre_eval(le,0.5);
+    _assert(equals_vector(pnm_sol,le->pnm,6,1e-10) &&
+    		equals_vector(dpnm_sol,le->dpnm,6,1e-10));
+	
+	// Zonal term of degree 4: sqrt(9)*P4(sin(fi))
+	double x = sin(0.5);
+	_assert(fabs(le->pnm[LEG_NM(4,0)] - 3.0*(35*pow(x,4)-30*x*x+3)/8) < 1e-12);
+	
+	// Orders above the maximum are left at zero
+	_assert(le->pnm[LEG_NM(4,3)] == 0.0 && le->pnm[LEG_NM(4,4)] == 0.0);
+	
+	// Truncated in a larger engine, as in one of that degree and order
+	LegendreEngine *big = Legendre_create(10,10);
+	Legendre_eval_nm(big,0.5,4,2);
+	for(int n=0; n<=4; n++) {
+		for(int m=0; m<=n && m<=2; m++) {
+			_assert(big->pnm[LEG_NM(n,m)] == le->pnm[LEG_NM(n,m)]);
+			_assert(big->dpnm[LEG_NM(n,m)] == le->dpnm[LEG_NM(n,m)]);
+		}
+	}
+	Legendre_free(big);
+	
+	Legendre_free(le);
+	
+    return 0;
+}
+
 /** @brief Unit test for function LTC.
  *
  *  @return 0=error, 1=pass.
@@ -903,11 +1128,10 @@ int LTC_01() {
 	A[1][0] = 0.341586711932422; A[1][1] = 0.136136938528208; A[1][2] = 0.929938305587722;
 	A[2][0] = -0.863859421119156; A[2][1] = -0.344284987681776; A[2][2] = 0.367715580035218;
     
-	double **R = LTC(-2.76234307910694,0.376551295459273);
-    _assert(equals_matrix(A,R,n,n,1e-10));
+	Mat3 R = LTC(-2.76234307910694,0.376551295459273);
+    _assert(equals_mat3(A,R,1e-10));
     
 	m_free(A,n,n);
-	m_free(R,n,n);
 	
     return 0;
 }
@@ -924,11 +1148,10 @@ int GHAMatrix_01() {
 	A[1][0] = 0.831518038538315; A[1][1] = -0.555497751197422; A[1][2] = 0.0;
 	A[2][0] = 0.0; A[2][1] = 0.0; A[2][2] = 1.0;
     
-	double **R = GHAMatrix(0.5);
-    _assert(equals_matrix(A,R,n,n,1e-10));
+	Mat3 R = GHAMatrix(0.5);
+    _assert(equals_mat3(A,R,1e-10));
     
 	m_free(A,n,n);
-	m_free(R,n,n);
 	
     return 0;
 }
@@ -975,6 +1198,63 @@ int Cheb3D_01() {
     return 0;
 }
 
+/** @brief Unit test for function Cheb_lanes.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int Cheb_lanes_01() {
+	// Five series of different length, across two blocks of lanes
+	double C0[3] = {5.0, 4.0, 3.0};
+	double C1[3] = {6.0, 7.0, 8.0};
+	double C2[3] = {2.0, 1.0, 0.0};
+	double C3[6] = {1.0, -2.0, 0.5, 0.25, -0.125, 0.0625};
+	double C4[1] = {7.0};
+	double *C[5] = {C0, C1, C2, C3, C4};
+	int N[5] = {3, 3, 3, 6, 1};
+	double tau[5] = {-0.9, -0.9, -0.9, 0.3, 1.0};
+	double f[5];
+	
+	Cheb_lanes(5, N, tau, C, f);
+	
+	double sol[5] = {3.26, 4.66, 1.1, 0.0, 7.0};
+	// Direct sum of the Chebyshev polynomials at tau = 0.3
+	double T[6] = {1.0, 0.3};
+	for(int i = 2; i < 6; i++)
+		T[i] = 2.0*0.3*T[i-1]-T[i-2];
+	for(int i = 0; i < 6; i++)
+		sol[3] += C3[i]*T[i];
+	
+	_assert(equals_vector(sol,f,5,1e-10));
+	
+    return 0;
+}
+
+/** @brief Unit test for function Cheb3D_batch.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int Cheb3D_batch_01() {
+	int n = 4, m = 7;
+	
+	double Cx[4] = {5.0, 4.0, 3.0, -1.0};
+	double Cy[4] = {6.0, 7.0, 8.0, 0.5};
+	double Cz[4] = {2.0, 1.0, 0.0, 2.0};
+	double t[7];
+	Vec3 r[7], s;
+	
+	for(int k = 0; k < m; k++)
+		t[k] = 10.0*k/(m-1);
+	
+	Cheb3D_batch(m,t,n,0,10,Cx,Cy,Cz,r);
+	
+	for(int k = 0; k < m; k++) {
+		s = Cheb3D_v3(t[k],n,0,10,Cx,Cy,Cz);
+		_assert(equals_vector(s.v,r[k].v,3,1e-12));
+	}
+	
+    return 0;
+}
+
 /** @brief Unit test for function elements.
  *
  *  @return 0=error, 1=pass.
@@ -1042,6 +1322,30 @@ int IERS_01() {
     return 0;
 }
 
+/** @brief Unit test for function IERS_eop.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int IERS_eop_01() {
+	EOP eop, day;
+	
+	IERS_eop(49746.1101504629, 'l', &eop);
+	_assert(fabs(-5.59386183152189e-07 - eop.x_pole) < 1e-10 &&
+			fabs(0.325764698106523 - eop.UT1_UTC) < 1e-10 &&
+			fabs(29 - eop.TAI_UTC) < 1e-10);
+	
+	// At midnight the interpolation gives the values of the day
+	IERS_eop(49746.0, 'l', &eop);
+	IERS_eop(49746.0, 'n', &day);
+	_assert(eop.x_pole == day.x_pole && eop.y_pole == day.y_pole &&
+			eop.UT1_UTC == day.UT1_UTC && eop.LOD == day.LOD &&
+			eop.dpsi == day.dpsi && eop.deps == day.deps &&
+			eop.dx_pole == day.dx_pole && eop.dy_pole == day.dy_pole &&
+			eop.TAI_UTC == day.TAI_UTC);
+    
+    return 0;
+}
+
 /** @brief Unit test for function angl.
  *
  *  @return 0=error, 1=pass.
@@ -1175,14 +1479,13 @@ int TimeUpdate_01() {
 	R_sol[3][0] = 39372.9209797587; R_sol[3][1] = 3284.34773933075; R_sol[3][2] = 4014.41933186659; R_sol[3][3] = 1001.21615369228; R_sol[3][4] = 1.320962491756; R_sol[3][5] = 1.6045548104278;
 	R_sol[4][0] = 3284.21675106589; R_sol[4][1] = 35369.9224513583; R_sol[4][2] = 2255.72532205054; R_sol[4][3] = 1.320962491756; R_sol[4][4] = 999.576829598137; R_sol[4][5] = 0.892927375360559;
 	R_sol[5][0] = 4014.15727751921; R_sol[5][1] = 2255.66799781441; R_sol[5][2] = 36274.7873542153; R_sol[5][3] = 1.6045548104278; R_sol[5][4] = 0.892927375360559; R_sol[5][5] = 999.924178045366;
-	double **R = TimeUpdate(P,Phi,Qdt);
-    _assert(equals_matrix(R_sol,R,n,n,1e-5));
+	TimeUpdate(P,Phi,Qdt);
+    _assert(equals_matrix(R_sol,P,n,n,1e-5));
     
 	m_free(P,n,n);
 	m_free(Phi,n,n);
 	m_free(Qdt,n,n);
 	m_free(R_sol,n,n);
-	m_free(R,n,n);
 	
     return 0;
 }
@@ -1209,8 +1512,8 @@ int MeasUpdate_01() {
 	P[4][0] = 3284.21675106589; P[4][1] = 35369.9224513583; P[4][2] = 2255.72532205054; P[4][3] = 1.320962491756; P[4][4] = 999.576829598137; P[4][5] = 0.892927375360559;
 	P[5][0] = 4014.15727751921; P[5][1] = 2255.66799781441; P[5][2] = 36274.7873542153; P[5][3] = 1.6045548104278; P[5][4] = 0.892927375360559; P[5][5] = 999.924178045366;
 	
-	double *K;
-	MeasUpdate(z,g,s,G,&K,&x,&P);
+	double *K = v_create(n);
+	MeasUpdate(z,g,s,G,K,x,P);
 	
 	double *K_sol = v_create(n);
 	K_sol[0] = 582691.20646825; K_sol[1] = 1312775.3084207; K_sol[2] = -1989454.89979193; K_sol[3] = 190.367307502019; K_sol[4] = 433.242659522805; K_sol[5] = -660.433799143302;
@@ -1252,16 +1555,15 @@ int AccelPointMass_01() {
 	s[0] = 92298251728.4766; s[1] = -105375196079.054; s[2] = -45686367226.3533;
     
 	double GM = 1.32712440041939e+20;
-	double *a = AccelPointMass(r,s,GM);
+	Vec3 a = AccelPointMass(v3_load(r),v3_load(s),GM);
 	
 	double *a_sol = v_create(n);
 	a_sol[0] = -1.8685505934417e-07; a_sol[1] = -2.00332995883182e-07; a_sol[2] = -1.59993120755489e-07;
-	_assert(equals_vector(a_sol,a,n,1e-17));
+	_assert(equals_vector(a_sol,a.v,n,1e-17));
 	
     
 	v_free(r,n);
 	v_free(s,n);
-	v_free(a,n);
 	v_free(a_sol,n);
 	
     return 0;
@@ -1277,29 +1579,266 @@ int AccelHarmonic_01() {
 	double *r = v_create(n);
 	r[0] = 6221397.62857869; r[1] = 2867713.77965741; r[2] = 3006155.9850995;
 	
-	double **E = m_create(n,n);
-	E[0][0] = -0.978185453896254; E[0][1] = 0.20773306636226; E[0][2] = -0.000436950239569363;
-	E[1][0] = -0.207733028352522; E[1][1] = -0.978185550768511; E[1][2] = -0.000131145697267082;
-	E[2][0] = -0.000454661708585098; E[2][1] = -3.75158169026289e-05; E[2][2] = 0.999999895937642;
+	Mat3 E;
+	E.m[0][0] = -0.978185453896254; E.m[0][1] = 0.20773306636226; E.m[0][2] = -0.000436950239569363;
+	E.m[1][0] = -0.207733028352522; E.m[1][1] = -0.978185550768511; E.m[1][2] = -0.000131145697267082;
+	E.m[2][0] = -0.000454661708585098; E.m[2][1] = -3.75158169026289e-05; E.m[2][2] = 0.999999895937642;
     
 	double n_max = 20,
 		   m_max = 20;
-	double *a = AccelHarmonic(r,E,n_max,m_max);
+	Vec3 a = AccelHarmonic(v3_load(r),E,n_max,m_max);
 	
 	double *a_sol = v_create(n);
 	a_sol[0] = -5.92414856522537; a_sol[1] = -2.73076679296887; a_sol[2] = -2.86933544780686;
 	
-	_assert(equals_vector(a_sol,a,n,1e-10));
+	_assert(equals_vector(a_sol,a.v,n,1e-10));
     
 	
 	v_free(r,n);
-	m_free(E,n,n);
-	v_free(a,n);
 	v_free(a_sol,n);
 	
     return 0;
 }
 
+/** @brief Unit test for the HARMONIC_CUNNINGHAM engine of
+ *  AccelHarmonic, on the case of AccelHarmonic_01 and over the
+ *  north pole, where the Legendre engine is singular.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int AccelHarmonic_02() {
+	const GravModel *g = GravModel_current();
+	Vec3 r = {{6221397.62857869, 2867713.77965741, 3006155.9850995}};
+	Mat3 E;
+	E.m[0][0] = -0.978185453896254; E.m[0][1] = 0.20773306636226; E.m[0][2] = -0.000436950239569363;
+	E.m[1][0] = -0.207733028352522; E.m[1][1] = -0.978185550768511; E.m[1][2] = -0.000131145697267082;
+	E.m[2][0] = -0.000454661708585098; E.m[2][1] = -3.75158169026289e-05; E.m[2][2] = 0.999999895937642;
+	
+	_assert(AccelHarmonic_engine(HARMONIC_CUNNINGHAM) == HARMONIC_LEGENDRE);
+	
+	double a_sol[3] = {-5.92414856522537, -2.73076679296887, -2.86933544780686};
+	Vec3 a = AccelHarmonic(r,E,20,20);
+	_assert(equals_vector(a_sol,a.v,3,1e-10));
+	
+	// Over the pole the radial part comes from the zonals alone, with
+	// Pn0(1) = sqrt(2n+1), and a zonal field has no horizontal part
+	double d = 7000e3, r_ref = g->r_ref, gm = g->gm;
+	double az = 0.0, rn = 1.0;
+	for(int n=0; n<=20; n++) {
+		az = az - gm/(d*d)*(n+1)*rn*sqrt(2.0*n+1)*GRAV_C(g,n,0);
+		rn = rn*r_ref/d;
+	}
+	Vec3 rp = {{0.0, 0.0, d}};
+	a = AccelHarmonic(rp,m3_eye(),20,20);
+	_assert(isfinite(a.v[0]) && isfinite(a.v[1]));
+	_assert(fabs(a.v[2]-az) < 1e-12*fabs(az));
+	a = AccelHarmonic(rp,m3_eye(),20,0);
+	_assert(fabs(a.v[0]) < 1e-12 && fabs(a.v[1]) < 1e-12);
+	_assert(fabs(a.v[2]-az) < 1e-12*fabs(az));
+	
+	_assert(AccelHarmonic_engine(HARMONIC_LEGENDRE) == HARMONIC_CUNNINGHAM);
+	
+    return 0;
+}
+
+/** @brief Unit test for function AccelHarmonic_batch, object by
+ *  object against AccelHarmonic, on a batch that does not fill its
+ *  last block.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int AccelHarmonic_batch_01() {
+	int N = 2*HARMONIC_LANES+1;
+	double x[2*HARMONIC_LANES+1], y[2*HARMONIC_LANES+1], z[2*HARMONIC_LANES+1];
+	double ax[2*HARMONIC_LANES+1], ay[2*HARMONIC_LANES+1], az[2*HARMONIC_LANES+1];
+	
+	for(int i=0; i<N; i++) {
+		double d = 6778e3 + 3e5*i, lat = 1.3*sin(0.7*i+0.2), lon = 0.9*i-2.5;
+		
+		x[i] = d*cos(lat)*cos(lon);
+		y[i] = d*cos(lat)*sin(lon);
+		z[i] = d*sin(lat);
+	}
+	
+	AccelHarmonic_batch(N,x,y,z,20,20,ax,ay,az);
+	for(int i=0; i<N; i++) {
+		Vec3 r = {{x[i], y[i], z[i]}};
+		Vec3 a = AccelHarmonic(r,m3_eye(),20,20);
+		
+		_assert(fabs(ax[i]-a.v[0]) < 1e-14 && fabs(ay[i]-a.v[1]) < 1e-14 && fabs(az[i]-a.v[2]) < 1e-14);
+	}
+	
+	// Truncated order
+	AccelHarmonic_batch(N,x,y,z,20,4,ax,ay,az);
+	for(int i=0; i<N; i++) {
+		Vec3 r = {{x[i], y[i], z[i]}};
+		Vec3 a = AccelHarmonic(r,m3_eye(),20,4);
+		
+		_assert(fabs(ax[i]-a.v[0]) < 1e-14 && fabs(ay[i]-a.v[1]) < 1e-14 && fabs(az[i]-a.v[2]) < 1e-14);
+	}
+	
+    return 0;
+}
+
+/** @brief Unit test for functions AccelHarmonic_degree,
+ *  AccelHarmonic_uses and AccelHarmonic_count.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int AccelHarmonic_degree_01() {
+	double tol = 1e-8;
+	
+	// Full degree low, lower degrees higher up
+	_assert(AccelHarmonic_degree(6778e3,20,tol) == 20);
+	_assert(AccelHarmonic_degree(42164e3,20,tol) < AccelHarmonic_degree(12000e3,20,tol));
+	_assert(AccelHarmonic_degree(12000e3,20,tol) < 20);
+	_assert(AccelHarmonic_degree(42164e3,20,1.0) == 0);
+	
+	// Omitted acceleration near the tolerance
+	for(int k=0; k<10; k++) {
+		double d = 12000e3, lat = 1.5*sin(0.37*k), lon = 0.77*k;
+		Vec3 r = {{d*cos(lat)*cos(lon), d*cos(lat)*sin(lon), d*sin(lat)}};
+		int n = AccelHarmonic_degree(d,20,tol);
+		long uses = AccelHarmonic_uses(n);
+		
+		Vec3 a = v3_sub(AccelHarmonic(r,m3_eye(),20,20),AccelHarmonic(r,m3_eye(),n,n));
+		_assert(v3_norm(a) < tol);
+		_assert(AccelHarmonic_uses(n) == uses+1);
+	}
+	
+	// Evaluations made outside AccelHarmonic
+	long uses = AccelHarmonic_uses(20);
+	AccelHarmonic_count(20,3);
+	_assert(AccelHarmonic_uses(20) == uses+3);
+	
+    return 0;
+}
+
+/** @brief Unit test for the gravity grid: interpolation against
+ *  the full model, over the pole and outside the grid, and reuse and
+ *  invalidation of the grid file.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int GravGrid_01() {
+	const char *file = "data/GravGrid_01.bin";
+	
+	remove(file);
+	GravGrid *g = GravGrid_create(file,8,8,6578e3,7578e3,11,37,72);
+	_assert(g->built == 1);
+	_assert(g->err > 0.0 && g->err < 1e-4);
+	
+	for(int k=0; k<20; k++) {
+		double d = 6600e3 + 45e3*k, lat = 1.5*sin(0.37*k), lon = 0.77*k - 3.0;
+		Vec3 r = {{d*cos(lat)*cos(lon), d*cos(lat)*sin(lon), d*sin(lat)}};
+		
+		_assert(v3_norm(v3_sub(GravGrid_accel(g,r,m3_eye()),AccelHarmonic(r,m3_eye(),8,8))) < 2*g->err);
+	}
+	
+	// Over the pole, against the singularity-free model
+	Vec3 rp = {{0.0, 0.0, 7000e3}};
+	_assert(v3_norm(v3_sub(GravGrid_accel(g,rp,m3_eye()),Cunningham(rp,m3_eye(),8,8,NULL))) < 2*g->err);
+	
+	// Outside the radius range, the full model
+	Vec3 ro = {{8000e3, 1000e3, 2000e3}};
+	Vec3 a = GravGrid_accel(g,ro,m3_eye()), b = AccelHarmonic(ro,m3_eye(),8,8);
+	_assert(a.v[0] == b.v[0] && a.v[1] == b.v[1] && a.v[2] == b.v[2]);
+	
+	// The same grid is mapped, another field is built
+	double err = g->err;
+	GravGrid_free(g);
+	g = GravGrid_create(file,8,8,6578e3,7578e3,11,37,72);
+	_assert(g->built == 0 && g->err == err);
+	GravGrid_free(g);
+	g = GravGrid_create(file,8,4,6578e3,7578e3,11,37,72);
+	_assert(g->built == 1);
+	GravGrid_free(g);
+	
+	remove(file);
+	
+    return 0;
+}
+
+/** @brief Unit test for the loading of gravity models: GGM03S.txt
+ *  truncated at a degree, and an ICGEM file with its own constants,
+ *  in order-major order and with Fortran exponents.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int GravModel_load_01() {
+	const char *file = "data/GravModel_01.gfc";
+	
+	GravModel *g = GravModel_load("data/GGM03S.txt",4);
+	_assert(g->n == 4 && ((size_t) g->cs) % GRAV_ALIGN == 0);
+	_assert(g->gm == 398600.4415e9 && g->r_ref == 6378.1363e3);
+	_assert(GRAV_C(g,0,0) == 1.0 && GRAV_S(g,0,0) == 0.0);
+	_assert(GRAV_C(g,2,0) == -4.841692638330e-04);
+	_assert(GRAV_C(g,2,2) == 2.439350113369e-06 && GRAV_S(g,2,2) == -1.400296540441e-06);
+	_assert(GRAV_C(g,3,1) == 2.030466388182e-06 && GRAV_S(g,3,1) == 2.482080433653e-07);
+	_assert(GRAV_C(g,4,4) != 0.0 && GRAV_S(g,4,4) != 0.0);
+	GravModel_free(g);
+	
+	FILE *fp = fopen(file,"w");
+	_assert(fp != NULL);
+	fprintf(fp,"product_type              gravity_field\n");
+	fprintf(fp,"earth_gravity_constant    3.986004415D+14\n");
+	fprintf(fp,"radius                    6.3781363E+06\n");
+	fprintf(fp,"max_degree                3\n");
+	fprintf(fp,"key    L    M    C                  S\n");
+	fprintf(fp,"end_of_head ================================\n");
+	fprintf(fp,"gfc    0    0  1.0                0.0\n");
+	fprintf(fp,"gfc    1    0  0.0                0.0\n");
+	fprintf(fp,"gfc    2    0 -4.84165371736D-04  0.0\n");
+	fprintf(fp,"gfc    3    0  1.0                0.0\n");
+	fprintf(fp,"gfc    1    1  0.0                0.0\n");
+	fprintf(fp,"gfc    2    1 -2.06615509074d-10  1.38441389137d-09\n");
+	fprintf(fp,"gfc    2    2  2.43914352398E-06 -1.40016683654E-06\n");
+	fprintf(fp,"gfc    3    3  1.0                1.0\n");
+	fclose(fp);
+	
+	g = GravModel_load(file,2);
+	_assert(g->n == 2 && g->gm == 3.986004415e14 && g->r_ref == 6.3781363e6);
+	_assert(GRAV_C(g,0,0) == 1.0 && GRAV_C(g,1,1) == 0.0);
+	_assert(GRAV_C(g,2,0) == -4.84165371736e-04);
+	_assert(GRAV_C(g,2,1) == -2.06615509074e-10 && GRAV_S(g,2,1) == 1.38441389137e-09);
+	_assert(GRAV_C(g,2,2) == 2.43914352398e-06 && GRAV_S(g,2,2) == -1.40016683654e-06);
+	
+	// Freeing the bound model unbinds it
+	GravModel *old = GravModel_bind(g);
+	long gen = GravModel_generation();
+	GravModel_free(g);
+	_assert(GravModel_current() == NULL && GravModel_generation() > gen);
+	GravModel_bind(old);
+	
+	remove(file);
+	
+    return 0;
+}
+
+/** @brief Unit test for the binary cache written by DE430Coeff.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int DE430Coeff_01() {
+	extern double **PC;
+	extern int fPC, cPC;
+	DE430Header h;
+	double first[2];
+	
+	FILE *fp = fopen("data/DE430Coeff.bin","rb");
+	_assert(fp != NULL);
+	_assert(fread(&h, sizeof(h), 1, fp) == 1);
+	_assert(fread(first, sizeof(double), 2, fp) == 2);
+	fclose(fp);
+	
+	_assert(strncmp(h.magic, "DE430BIN", 8) == 0);
+	_assert(h.records == fPC && h.coeffs == cPC);
+	_assert(h.jd_first == PC[0][0] && h.jd_last == PC[fPC-1][1]);
+	_assert(first[0] == PC[0][0] && first[1] == PC[0][1]);
+    
+    return 0;
+}
+
 /** @brief Unit test for function JPL_Eph_DE430.
  *
  *  @return 0=error, 1=pass.
@@ -1377,6 +1916,110 @@ int JPL_Eph_DE430_01() {
     return 0;
 }
 
+/** @brief Unit test for the record lookup of function JPL_Eph_DE430.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int JPL_Eph_DE430_02() {
+	extern double **PC;
+	double *r[4][11];
+	
+	// Same epoch before and after a jump to another record and to the
+	// end of the first record
+	double Mjd_TDB[4] = {49746.1119928785, 49846.1119928785,
+						 PC[0][1] - 2400000.5, 49746.1119928785};
+	
+	for(int k = 0; k < 4; k++) {
+		double **p = r[k];
+		
+		JPL_Eph_DE430(Mjd_TDB[k], &p[0], &p[1], &p[2], &p[3], &p[4], &p[5],
+					  &p[6], &p[7], &p[8], &p[9], &p[10]);
+	}
+	
+	for(int b = 0; b < 11; b++) {
+		_assert(memcmp(r[0][b], r[3][b], 3*sizeof(double)) == 0);
+	}
+	
+	for(int k = 0; k < 4; k++)
+		for(int b = 0; b < 11; b++)
+			v_free(r[k][b],3);
+    
+    return 0;
+}
+
+/** @brief Unit test for functions JPL_Eph_DE430_bodies and
+ *  JPL_Eph_DE430_body.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int JPL_Eph_DE430_03() {
+	double Mjd_TDB = 49746.1119928785;
+	double *p[JPL_BODIES];
+	Vec3 r[JPL_BODIES];
+	
+	JPL_Eph_DE430(Mjd_TDB, &p[JPL_MERCURY], &p[JPL_VENUS], &p[JPL_EARTH], &p[JPL_MARS],
+				  &p[JPL_JUPITER], &p[JPL_SATURN], &p[JPL_URANUS], &p[JPL_NEPTUNE],
+				  &p[JPL_PLUTO], &p[JPL_MOON], &p[JPL_SUN]);
+	
+	// Every body on its own gives the same position
+	for(int b = 0; b < JPL_BODIES; b++) {
+		Vec3 s = JPL_Eph_DE430_body(Mjd_TDB, b);
+		_assert(memcmp(s.v, p[b], 3*sizeof(double)) == 0);
+	}
+	
+	// Bodies outside the mask are not touched
+	r[JPL_SUN] = v3_load(p[JPL_MERCURY]);
+	JPL_Eph_DE430_bodies(Mjd_TDB, JPL_MASK(JPL_MOON), r);
+	_assert(memcmp(r[JPL_MOON].v, p[JPL_MOON], 3*sizeof(double)) == 0);
+	_assert(memcmp(r[JPL_SUN].v, p[JPL_MERCURY], 3*sizeof(double)) == 0);
+	
+	for(int b = 0; b < JPL_BODIES; b++)
+		v_free(p[b],3);
+    
+    return 0;
+}
+
+/** @brief Unit test for the coefficient blocks of function
+ *  JPL_Eph_DE430 past the first sub-interval: the Moon in its eighth
+ *  4-day sub-interval, Mercury in its fourth 8-day one and the Sun in
+ *  its second 16-day one, against Cheb3D on the blocks of the DE430
+ *  layout. The Earth cancels out of Mercury minus the Sun.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int JPL_Eph_DE430_04() {
+	extern double **PC;
+	extern int fPC;
+	double *rec = PC[fPC/2];
+	double t1 = rec[0] - 2400000.5;
+	double Mjd_TDB = t1 + 29.5;
+	double *p[JPL_BODIES];
+	
+	JPL_Eph_DE430(Mjd_TDB, &p[JPL_MERCURY], &p[JPL_VENUS], &p[JPL_EARTH], &p[JPL_MARS],
+				  &p[JPL_JUPITER], &p[JPL_SATURN], &p[JPL_URANUS], &p[JPL_NEPTUNE],
+				  &p[JPL_PLUTO], &p[JPL_MOON], &p[JPL_SUN]);
+	
+	// Moon: 13 coefficients from 441, sub-interval 7 of 8
+	double *c = &rec[440 + 3*13*7];
+	Vec3 moon = v3_mul_scalar(Cheb3D_v3(Mjd_TDB, 13, t1+28, t1+32, c, c+13, c+26), 1e3);
+	_assert(equals_vector(moon.v, p[JPL_MOON], 3, 1e-3));
+	
+	// Mercury: 14 coefficients from 3, sub-interval 3 of 4; Sun: 11
+	// coefficients from 753, sub-interval 1 of 2
+	c = &rec[2 + 3*14*3];
+	Vec3 mercury = Cheb3D_v3(Mjd_TDB, 14, t1+24, t1+32, c, c+14, c+28);
+	c = &rec[752 + 3*11*1];
+	Vec3 sun = Cheb3D_v3(Mjd_TDB, 11, t1+16, t1+32, c, c+11, c+22);
+	Vec3 d_sol = v3_mul_scalar(v3_sub(mercury, sun), 1e3);
+	Vec3 d = v3_sub(v3_load(p[JPL_MERCURY]), v3_load(p[JPL_SUN]));
+	_assert(equals_vector(d_sol.v, d.v, 3, 1e-3));
+	
+	for(int b = 0; b < JPL_BODIES; b++)
+		v_free(p[b],3);
+    
+    return 0;
+}
+
 /** @brief Unit test for function Accel.
  *
  *  @return 0=error, 1=pass.
@@ -1413,6 +2056,41 @@ int Accel_01() {
     return 0;
 }
 
+/** @brief Unit test for function Cunningham.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int Cunningham_01() {
+	Vec3 r = {{6221397.62857869, 2867713.77965741, 3006155.9850995}};
+	Mat3 E, G;
+	E.m[0][0] = -0.978185453896254; E.m[0][1] = 0.20773306636226; E.m[0][2] = -0.000436950239569363;
+	E.m[1][0] = -0.207733028352522; E.m[1][1] = -0.978185550768511; E.m[1][2] = -0.000131145697267082;
+	E.m[2][0] = -0.000454661708585098; E.m[2][1] = -3.75158169026289e-05; E.m[2][2] = 0.999999895937642;
+	
+	// Same acceleration as AccelHarmonic_01
+	double a_sol[3] = {-5.92414856522537, -2.73076679296887, -2.86933544780686};
+	Vec3 a = Cunningham(r,E,20,20,NULL);
+	_assert(equals_vector(a_sol,a.v,3,1e-10));
+	
+	// Same gradient as G_AccelHarmonic_01
+	Vec3 rg = {{5542555.93722869, 3213514.86734919, 3990892.97587674}};
+	Mat3 U;
+	U.m[0][0] = -0.976675972331716; U.m[0][1] = 0.214718082511189; U.m[0][2] = -0.000436019054674645;
+	U.m[1][0] = -0.214718043811152; U.m[1][1] = -0.976676068937815; U.m[1][2] = -0.000134261271504216;
+	U.m[2][0] = -0.000454677699074514; U.m[2][1] = -3.750859940872e-05; U.m[2][2] = 0.999999895930642;
+	
+	double **G_sol = m_create(3,3);
+	G_sol[0][0] = 5.70032034907797e-07; G_sol[0][1] = 8.67651590574781e-07; G_sol[0][2] = 1.08169354007259e-06;
+	G_sol[1][0] = 8.67651592351137e-07; G_sol[1][1] = -4.23359107770693e-07; G_sol[1][2] = 6.27183704970946e-07;
+	G_sol[2][0] = 1.08169353918441e-06; G_sol[2][1] = 6.27183701418232e-07; G_sol[2][2] = -1.46672925360747e-07;
+	a = Cunningham(rg,U,20,20,&G);
+	_assert(equals_mat3(G_sol,G,1e-12));
+	
+	m_free(G_sol,3,3);
+	
+    return 0;
+}
+
 /** @brief Unit test for function G_AccelHarmonic.
  *
  *  @return 0=error, 1=pass.
@@ -1423,26 +2101,24 @@ int G_AccelHarmonic_01() {
 	double *r = v_create(n);
 	r[0] = 5542555.93722869; r[1] = 3213514.86734919; r[2] = 3990892.97587674;
 	
-	double **U = m_create(n,n);
-	U[0][0] = -0.976675972331716; U[0][1] = 0.214718082511189; U[0][2] = -0.000436019054674645;
-	U[1][0] = -0.214718043811152; U[1][1] = -0.976676068937815; U[1][2] = -0.000134261271504216;
-	U[2][0] = -0.000454677699074514; U[2][1] = -3.750859940872e-05; U[2][2] = 0.999999895930642;
+	Mat3 U;
+	U.m[0][0] = -0.976675972331716; U.m[0][1] = 0.214718082511189; U.m[0][2] = -0.000436019054674645;
+	U.m[1][0] = -0.214718043811152; U.m[1][1] = -0.976676068937815; U.m[1][2] = -0.000134261271504216;
+	U.m[2][0] = -0.000454677699074514; U.m[2][1] = -3.750859940872e-05; U.m[2][2] = 0.999999895930642;
     
 	double n_max = 20,
 		   m_max = 20;
-	double **G = G_AccelHarmonic(r,U,n_max,m_max);
+	Mat3 G = G_AccelHarmonic(v3_load(r),U,n_max,m_max);
 	
 	
 	double **G_sol = m_create(n,n);
 	G_sol[0][0] = 5.70032034907797e-07; G_sol[0][1] = 8.67651590574781e-07; G_sol[0][2] = 1.08169354007259e-06;
 	G_sol[1][0] = 8.67651592351137e-07; G_sol[1][1] = -4.23359107770693e-07; G_sol[1][2] = 6.27183704970946e-07;
 	G_sol[2][0] = 1.08169353918441e-06; G_sol[2][1] = 6.27183701418232e-07; G_sol[2][2] = -1.46672925360747e-07;
-	_assert(equals_matrix(G_sol,G,n,n,1e-12));
+	_assert(equals_mat3(G_sol,G,1e-12));
     
 	
 	v_free(r,n);
-	m_free(U,n,n);
-	m_free(G,n,n);
 	m_free(G_sol,n,n);
 	
     return 0;
@@ -1490,6 +2166,85 @@ int VarEqn_01() {
     return 0;
 }
 
+/** @brief Unit test for function VarEqn_full: the state derivative
+ *  is that of Accel, the derivative of the state transition matrix
+ *  that of VarEqn. The force model is the harmonic field alone, which
+ *  needs no ephemerides, so both give the same acceleration too.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int VarEqn_full_01() {
+	int n = 42;
+	
+	extern Param AuxParam;
+	AuxParam.Mjd_UTC = 49746.1101504629;
+	AuxParam.n = 20;
+	AuxParam.m = 20;
+	AuxParam.sun = 0;
+	AuxParam.moon = 0;
+	AuxParam.planets = 0;
+	AuxParam.tol = 0.0;
+	
+	double x = 30.0;
+	double *yPhi = v_create(n);
+	yPhi[0] = 5542555.93722869; yPhi[1] = 3213514.86734919; yPhi[2] = 3990892.97587674;
+	yPhi[3] = 5394.06842166295; yPhi[4] = -2365.21337882319; yPhi[5] = -7061.84554200204;
+	for(int k=6; k<n; k++) {
+		yPhi[k] = 1e-3*k;
+	}
+	
+	double *yPhip, *yPhip_var, *dY;
+	VarEqn_full(x,yPhi,&yPhip);
+	VarEqn(x,yPhi,&yPhip_var);
+	Accel(x,yPhi,&dY);
+	
+	_assert(equals_vector(dY,yPhip,6,1e-12));
+	_assert(equals_vector(yPhip_var,yPhip,6,1e-12));
+	_assert(equals_vector(&yPhip_var[6],&yPhip[6],36,1e-20));
+	
+	v_free(yPhi,n);
+	v_free(yPhip,n);
+	v_free(yPhip_var,n);
+	v_free(dY,6);
+	
+    return 0;
+}
+
+/** @brief Unit test for the Earth rotation provider.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int EarthRot_01() {
+	double Mjd = 49746.1101504629;
+	
+	EarthRot *er = EarthRot_create(Mjd, Mjd+1.0, 1e-10);
+	_assert(er->err <= 1e-10);
+	
+	for(int i = 0; i <= 10; i++) {
+		double t = Mjd + 0.1*i + 0.0123;
+		Mat3 NP = m3_dot(NutMatrix(t),PrecMatrix((MJD_J2000),t));
+		Mat3 R = EarthRot_NP(er,t);
+		Mat3 G = GHAMatrix(t);
+		Mat3 S = EarthRot_GHA(er,t);
+		
+		for(int j = 0; j < 3; j++)
+			for(int k = 0; k < 3; k++) {
+				_assert(fabs(NP.m[j][k]-R.m[j][k]) < 1e-10);
+				_assert(fabs(G.m[j][k]-S.m[j][k]) < 1e-10);
+			}
+	}
+	
+	// Exact outside the arc and without provider
+	Mat3 G = GHAMatrix(Mjd+10.0);
+	Mat3 S = EarthRot_GHA(er,Mjd+10.0);
+	Mat3 R = EarthRot_GHA(NULL,Mjd+10.0);
+	_assert(memcmp(&G,&S,sizeof(Mat3)) == 0 && memcmp(&G,&R,sizeof(Mat3)) == 0);
+	
+	EarthRot_free(er);
+    
+    return 0;
+}
+
 /** @brief Unit test for function ode.
  *
  *  @return 0=error, 1=pass.
@@ -1518,6 +2273,321 @@ int ode_01() {
     return 0;
 }
 
+// Harmonic oscillator, counting its evaluations
+static int oscillator_evals = 0;
+
+static void oscillator(double t, double *y, double **yp) {
+	(void) t;
+	*yp = v_create(2);
+	(*yp)[0] = y[1];
+	(*yp)[1] = -y[0];
+	oscillator_evals++;
+}
+
+/** @brief Unit test for the integrator context: warm continuation
+ *  over output points, against the exact solution of an oscillator
+ *  and against cold restarts, and a warm restart from a corrected
+ *  state.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int ode_context_01() {
+	int iflag, iwork[5], warm, cold;
+	double y[2], t, work[100 + 21 * 2];
+	
+	OdeContext *c = ode_create(oscillator, 2, 1e-12, 1e-12);
+	ode_start(c, 0.0);
+	y[0] = 1.0; y[1] = 0.0;
+	oscillator_evals = 0;
+	for(int k=1; k<=10; k++) {
+		_assert(ode_advance(c, y, k) == 2);
+		_assert(c->t == k);
+		_assert(fabs(y[0]-cos(k)) < 1e-9 && fabs(y[1]+sin(k)) < 1e-9);
+	}
+	warm = oscillator_evals;
+	
+	// Restarting at every output point
+	y[0] = 1.0; y[1] = 0.0;
+	oscillator_evals = 0;
+	for(int k=1; k<=10; k++) {
+		t = k-1;
+		iflag = 1;
+		ode(oscillator, 2, y, &t, k, 1e-12, 1e-12, &iflag, work, iwork);
+	}
+	cold = oscillator_evals;
+	_assert(warm < cold);
+	
+	// Corrected state at t = 10, then on to 12
+	double y0 = cos(10.0) + 1e-3, v0 = -sin(10.0) - 2e-3;
+	y[0] = y0; y[1] = v0;
+	ode_correct(c, y);
+	_assert(ode_advance(c, y, 12.0) == 2);
+	_assert(fabs(y[0]-(y0*cos(2.0)+v0*sin(2.0))) < 1e-9);
+	_assert(fabs(y[1]-(v0*cos(2.0)-y0*sin(2.0))) < 1e-9);
+	ode_free(c);
+	
+    return 0;
+}
+
+/** @brief Unit test for the dense output of ode_arc: the oscillator
+ *  over an arc queried at every tenth of a unit, against the exact
+ *  solution, against landing on every output point, and with
+ *  tolerances too small.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int ode_arc_01() {
+	double y[2], yp[2], z[2];
+	int dense, landing;
+	
+	OdeContext *c = ode_create(oscillator, 2, 1e-12, 1e-12);
+	OdeArc *a = ode_arc_create(2);
+	ode_start(c, 0.0);
+	y[0] = 1.0; y[1] = 0.0;
+	oscillator_evals = 0;
+	_assert(ode_arc(c, y, 20.0, a) == 2);
+	dense = oscillator_evals;
+	_assert(c->t == 20.0 && a->n > 10 && a->x[a->n-1] == 20.0);
+	_assert(fabs(y[0]-cos(20.0)) < 1e-9 && fabs(y[1]+sin(20.0)) < 1e-9);
+	for(int k=0; k<=200; k++) {
+		double t = 0.1*k;
+		
+		ode_arc_eval(a, t, z, yp);
+		_assert(fabs(z[0]-cos(t)) < 1e-9 && fabs(z[1]+sin(t)) < 1e-9);
+		_assert(fabs(yp[0]+sin(t)) < 1e-9 && fabs(yp[1]+cos(t)) < 1e-9);
+	}
+	
+	// The context goes on from the end of the arc
+	_assert(ode_advance(c, y, 21.0) == 2);
+	_assert(fabs(y[0]-cos(21.0)) < 1e-9 && fabs(y[1]+sin(21.0)) < 1e-9);
+	
+	// Landing on every output point instead
+	ode_start(c, 0.0);
+	y[0] = 1.0; y[1] = 0.0;
+	oscillator_evals = 0;
+	for(int k=1; k<=200; k++) {
+		ode_advance(c, y, 0.1*k);
+	}
+	landing = oscillator_evals;
+	_assert(dense < landing);
+	ode_free(c);
+	
+	// Tolerances too small, increased on the way
+	c = ode_create(oscillator, 2, 1e-20, 1e-20);
+	ode_start(c, 0.0);
+	y[0] = 1.0; y[1] = 0.0;
+	_assert(ode_arc(c, y, 20.0, a) == 3);
+	_assert(c->t == 20.0 && c->relerr > 1e-20);
+	_assert(fabs(y[0]-cos(20.0)) < 1e-9 && fabs(y[1]+sin(20.0)) < 1e-9);
+	
+	ode_arc_free(a);
+	ode_free(c);
+	
+    return 0;
+}
+
+/** @brief Unit test for the ODE_DOP853 method of a context: output
+ *  points forwards and backwards against the exact solution of an
+ *  oscillator, a corrected state, and the cost of a tighter tolerance
+ *  against the order of the method.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int ode_dop853_01() {
+	double y[2];
+	int loose, tight;
+	
+	OdeContext *c = ode_create(oscillator, 2, 1e-12, 1e-12);
+	_assert(ode_method(c, ODE_DOP853) == ODE_ADAMS);
+	ode_start(c, 0.0);
+	y[0] = 1.0; y[1] = 0.0;
+	for(int k=1; k<=10; k++) {
+		_assert(ode_advance(c, y, k) == 2);
+		_assert(c->t == k);
+		_assert(fabs(y[0]-cos(k)) < 1e-10 && fabs(y[1]+sin(k)) < 1e-10);
+	}
+	
+	// Back to t = 5
+	_assert(ode_advance(c, y, 5.0) == 2);
+	_assert(fabs(y[0]-cos(5.0)) < 1e-10 && fabs(y[1]+sin(5.0)) < 1e-10);
+	
+	// Corrected state at t = 5, then on to 7
+	double y0 = cos(5.0) + 1e-3, v0 = -sin(5.0) - 2e-3;
+	y[0] = y0; y[1] = v0;
+	ode_correct(c, y);
+	_assert(ode_advance(c, y, 7.0) == 2);
+	_assert(fabs(y[0]-(y0*cos(2.0)+v0*sin(2.0))) < 1e-10);
+	_assert(fabs(y[1]-(v0*cos(2.0)-y0*sin(2.0))) < 1e-10);
+	
+	// Order 8: 10^4 in the tolerance is some 10^0.5 in the steps
+	c->relerr = c->abserr = 1e-8;
+	ode_start(c, 0.0);
+	y[0] = 1.0; y[1] = 0.0;
+	oscillator_evals = 0;
+	_assert(ode_advance(c, y, 100.0) == 2);
+	_assert(fabs(y[0]-cos(100.0)) < 1e-6);
+	loose = oscillator_evals;
+	c->relerr = c->abserr = 1e-12;
+	ode_start(c, 0.0);
+	y[0] = 1.0; y[1] = 0.0;
+	oscillator_evals = 0;
+	_assert(ode_advance(c, y, 100.0) == 2);
+	_assert(fabs(y[0]-cos(100.0)) < 1e-10);
+	tight = oscillator_evals;
+	_assert(tight < 5*loose);
+	ode_free(c);
+	
+    return 0;
+}
+
+/** @brief Unit test for the statistics of a context: evaluations
+ *  against those counted by f, the histograms against the steps, and
+ *  the cost of a step of ODE_DOP853.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int ode_stats_01() {
+	double y[2];
+	long orders, bins;
+	
+	OdeContext *c = ode_create(oscillator, 2, 1e-12, 1e-12);
+	ode_start(c, 0.0);
+	y[0] = 1.0; y[1] = 0.0;
+	oscillator_evals = 0;
+	for(int k=1; k<=10; k++)
+		ode_advance(c, y, k);
+	ode_correct(c, y);
+	_assert(c->stats.evals == oscillator_evals);
+	_assert(c->stats.steps > 0 && c->stats.evals > c->stats.steps);
+	orders = bins = 0;
+	for(int i=0; i<=ODE_STATS_ORDERS; i++)
+		orders += c->stats.order[i];
+	for(int i=0; i<ODE_STATS_BINS; i++)
+		bins += c->stats.step[i];
+	_assert(orders == c->stats.steps && bins == c->stats.steps);
+	_assert(0.0 < c->stats.f_time && c->stats.f_time <= c->stats.time);
+	
+	ode_stats_reset(c);
+	_assert(c->stats.evals == 0 && c->stats.steps == 0 && c->stats.time == 0.0);
+	
+	// Two evaluations to start, 11 per step tried and 1 per step taken
+	ode_method(c, ODE_DOP853);
+	ode_start(c, 0.0);
+	y[0] = 1.0; y[1] = 0.0;
+	_assert(ode_advance(c, y, 10.0) == 2);
+	_assert(c->stats.evals == 2 + 12*c->stats.steps + 11*c->stats.rejected);
+	_assert(c->stats.order[8] == c->stats.steps);
+	ode_free(c);
+	
+    return 0;
+}
+
+// Two-body problem of the Earth, counting its evaluations
+static int kepler_evals = 0;
+
+static void kepler(double t, double *y, double **yp) {
+	double r = sqrt(y[0]*y[0] + y[1]*y[1] + y[2]*y[2]);
+	double k = -GM_Earth/(r*r*r);
+	
+	(void) t;
+	*yp = v_create(6);
+	(*yp)[0] = y[3]; (*yp)[1] = y[4]; (*yp)[2] = y[5];
+	(*yp)[3] = k*y[0]; (*yp)[4] = k*y[1]; (*yp)[5] = k*y[2];
+	kepler_evals++;
+}
+
+/** @brief Unit test for the ODE_GAUSS_JACKSON method of a context:
+ *  the two-body orbit of the GEOS3 state at 30 s steps against ode
+ *  over an orbit, at output points between the nodes, and back to
+ *  the epoch.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int ode_gauss_jackson_01() {
+	int iflag = 1, iwork[5], evals;
+	double t = 0.0, work[100 + 21 * 6], Y[6], Y_ode[6];
+	const double Y0[6] = {6221397.62857869, 2867713.77965741, 3006155.9850995,
+						  4645.0472516175, -2752.21591588182, -7507.99940986939};
+	
+	OdeContext *c = ode_create(kepler, 6, 1e-13, 1e-6);
+	_assert(ode_method(c, ODE_GAUSS_JACKSON) == ODE_ADAMS);
+	c->h = 30.0;
+	ode_start(c, 0.0);
+	memcpy(Y, Y0, sizeof(Y));
+	memcpy(Y_ode, Y0, sizeof(Y));
+	kepler_evals = 0;
+	for(int k = 1; k <= 10; k++) {
+		_assert(ode_advance(c, Y, 605.0*k) == 2);
+		evals = kepler_evals;
+		ode(kepler, 6, Y_ode, &t, 605.0*k, 1e-13, 1e-6, &iflag, work, iwork);
+		kepler_evals = evals;
+		_assert(equals_vector(Y_ode, Y, 3, 1e-3) && equals_vector(Y_ode+3, Y+3, 3, 1e-6));
+	}
+	_assert(kepler_evals < 2*6050/30);
+	
+	_assert(ode_advance(c, Y, 0.0) == 2);
+	_assert(equals_vector((double *) Y0, Y, 3, 1e-3));
+	ode_free(c);
+	
+    return 0;
+}
+
+/** @brief Unit test for the Gauss-Jackson method of an integrator
+ *  context on the GEOS3 orbit with the full force model (20x20 field,
+ *  Sun, Moon and planets): against the Adams method of ode over 10
+ *  intervals of 600 s, within 1 mm and 1 um/s, and through a warm
+ *  restart with ode_correct.
+ *
+ *  @return 0=error, 1=pass.
+ */
+int ode_gauss_jackson_02() {
+	int iflag = 1, iwork[5];
+	double t = 0.0, work[100 + 21 * 6], Y[6], Y_ode[6];
+	const double Y0[6] = {6221397.62857869, 2867713.77965741, 3006155.9850995,
+						  4645.0472516175, -2752.21591588182, -7507.99940986939};
+	
+	extern Param AuxParam;
+	Param aux = AuxParam;
+	AuxParam.Mjd_UTC = 49746.1112847221;
+	AuxParam.n = 20;
+	AuxParam.m = 20;
+	AuxParam.sun = 1;
+	AuxParam.moon = 1;
+	AuxParam.planets = 1;
+	AuxParam.tol = 0.0;
+	GravGrid *grid = GravGrid_bind(NULL);
+	
+	OdeContext *c = ode_create(Accel, 6, 1e-13, 1e-6);
+	ode_method(c, ODE_GAUSS_JACKSON);
+	c->h = 30.0;
+	ode_start(c, 0.0);
+	memcpy(Y, Y0, sizeof(Y));
+	memcpy(Y_ode, Y0, sizeof(Y));
+	for(int k = 1; k <= 10; k++) {
+		_assert(ode_advance(c, Y, 600.0*k) == 2);
+		ode(Accel, 6, Y_ode, &t, 600.0*k, 1e-13, 1e-6, &iflag, work, iwork);
+		_assert(equals_vector(Y_ode, Y, 3, 1e-3) && equals_vector(Y_ode+3, Y+3, 3, 1e-6));
+	}
+	
+	// A velocity change of 1 m/s at 6000 s, in both
+	Y[3] = Y[3] + 1.0;
+	Y_ode[3] = Y_ode[3] + 1.0;
+	ode_correct(c, Y);
+	_assert(c->iflag == 2);
+	iflag = 1;
+	for(int k = 11; k <= 15; k++) {
+		_assert(ode_advance(c, Y, 600.0*k) == 2);
+		ode(Accel, 6, Y_ode, &t, 600.0*k, 1e-13, 1e-6, &iflag, work, iwork);
+		_assert(equals_vector(Y_ode, Y, 3, 1e-3) && equals_vector(Y_ode+3, Y+3, 3, 1e-6));
+	}
+	ode_free(c);
+	
+	GravGrid_bind(grid);
+	AuxParam = aux;
+	
+    return 0;
+}
+
 /** @brief Unit test for function poly_roots.
  *
  *  @return 0=error, 1=pass.
@@ -1615,6 +2685,11 @@ int all_tests() {
     _verify(m_dot_01);
     _verify(inv_01);
     _verify(trans_01);
+    _verify(v_axpy_01);
+    _verify(m_dot_into_01);
+    _verify(m_dot_trans_into_01);
+    _verify(arena_01);
+    _verify(mem_totals_01);
 	
 	_verify(position_01);
     _verify(R_x_01);
@@ -1637,12 +2712,16 @@ int all_tests() {
     _verify(gast_01);
     _verify(Geodetic_01);
     _verify(Legendre_01);
+    _verify(Legendre_eval_01);
     _verify(LTC_01);
     _verify(GHAMatrix_01);
     _verify(EccAnom_01);
     _verify(Cheb3D_01);
+    _verify(Cheb_lanes_01);
+    _verify(Cheb3D_batch_01);
     _verify(elements_01);
     _verify(IERS_01);
+    _verify(IERS_eop_01);
     _verify(angl_01);
     _verify(gibbs_01);
     _verify(hgibbs_01);
@@ -1650,12 +2729,30 @@ int all_tests() {
     _verify(MeasUpdate_01);
     _verify(AccelPointMass_01);
 	_verify(AccelHarmonic_01);
+	_verify(AccelHarmonic_02);
+	_verify(AccelHarmonic_batch_01);
+	_verify(AccelHarmonic_degree_01);
+	_verify(GravGrid_01);
+	_verify(GravModel_load_01);
+	_verify(DE430Coeff_01);
 	_verify(JPL_Eph_DE430_01);
+	_verify(JPL_Eph_DE430_02);
+	_verify(JPL_Eph_DE430_03);
+	_verify(JPL_Eph_DE430_04);
 	_verify(Accel_01);
 	_verify(G_AccelHarmonic_01);
+	_verify(Cunningham_01);
 	_verify(VarEqn_01);
+	_verify(VarEqn_full_01);
+	_verify(EarthRot_01);
 	
 	_verify(ode_01);
+	_verify(ode_context_01);
+	_verify(ode_arc_01);
+	_verify(ode_dop853_01);
+	_verify(ode_gauss_jackson_01);
+	_verify(ode_gauss_jackson_02);
+	_verify(ode_stats_01);
 
 	_verify(poly_roots_01);
 	_verify(anglesg_01);
@@ -1667,7 +2764,7 @@ int all_tests() {
 //int main()
 //{
 //	DE430Coeff(2285,1020);
-//	GGM03S(182);
+//	GGM03S(181);
 //	eop19620101(21413);
 //	GEOS3(46);
 //